@@ -0,0 +1,259 @@
+/*
+ * Arena allocator for list-owned data.
+ * Copyright (C) 2026 Jiri Denemark
+ *
+ * This file is part of gkrellm-tz.
+ *
+ * gkrellm-tz is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/** @file
+ * Arena allocator for list-owned data.
+ * @author Jiri Denemark
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "arena.h"
+#include "mem.h"
+
+/** Size of the first block. */
+#define ARENA_BLOCK     (64 * 1024)
+/** Alignment of all allocations. */
+#define ARENA_ALIGN     16
+/** Round size up to alignment. */
+#define arena_round(size)   (((size) + ARENA_ALIGN - 1) & ~(size_t) (ARENA_ALIGN - 1))
+
+
+/** Block of arena memory, data follow the header. */
+struct tz_arena_block {
+    /** Previously allocated block. */
+    struct tz_arena_block *prev;
+    /** Usable size of the block. */
+    size_t size;
+    /** Number of bytes already allocated. */
+    size_t used;
+};
+
+/** Size of block header keeping data aligned. */
+#define ARENA_HEADER    arena_round(sizeof(struct tz_arena_block))
+
+
+/** Initialize an empty arena.
+ *
+ * @param arena
+ *      arena.
+ *
+ * @return
+ *      nothing.
+ */
+void
+tz_arena_init(struct tz_arena *arena)
+{
+    arena->block = NULL;
+    arena->strings = NULL;
+    arena->strings_size = 0;
+    arena->strings_count = 0;
+}
+
+
+/** Allocate memory from an arena.
+ * Each new block is at least twice as big as the previous one so that
+ * the number of blocks grows logarithmically with the amount of data.
+ *
+ * @param arena
+ *      arena.
+ *
+ * @param size
+ *      number of bytes.
+ *
+ * @return
+ *      pointer to aligned memory or NULL on error. The memory is valid
+ *      until the arena is reset or freed.
+ */
+void *
+tz_arena_alloc(struct tz_arena *arena, size_t size)
+{
+    struct tz_arena_block *block = arena->block;
+    void *p;
+
+    size = arena_round(size);
+
+    if (block == NULL || block->size - block->used < size) {
+        size_t block_size = (block != NULL) ? 2 * block->size : ARENA_BLOCK;
+
+        while (block_size < size)
+            block_size *= 2;
+
+        block = (struct tz_arena_block *) tz_mem_alloc(ARENA_HEADER
+                                                       + block_size);
+        if (block == NULL)
+            return NULL;
+
+        block->prev = arena->block;
+        block->size = block_size;
+        block->used = 0;
+        arena->block = block;
+    }
+
+    p = (char *) block + ARENA_HEADER + block->used;
+    block->used += size;
+
+    return p;
+}
+
+
+/** Hash a string (FNV-1a). */
+static size_t
+arena_hash(const char *str)
+{
+    size_t hash = 2166136261U;
+
+    while (*str != '\0') {
+        hash ^= (unsigned char) *str++;
+        hash *= 16777619U;
+    }
+
+    return hash;
+}
+
+
+/** Double the size of the table of interned strings. */
+static int
+arena_strings_grow(struct tz_arena *arena)
+{
+    size_t size = (arena->strings_size > 0) ? 2 * arena->strings_size : 64;
+    const char **strings;
+    size_t i;
+    size_t j;
+
+    strings = (const char **) tz_arena_alloc(arena, size * sizeof(*strings));
+    if (strings == NULL)
+        return -1;
+    memset((void *) strings, '\0', size * sizeof(*strings));
+
+    for (i = 0; i < arena->strings_size; i++) {
+        if (arena->strings[i] == NULL)
+            continue;
+        j = arena_hash(arena->strings[i]) & (size - 1);
+        while (strings[j] != NULL)
+            j = (j + 1) & (size - 1);
+        strings[j] = arena->strings[i];
+    }
+
+    arena->strings = strings;
+    arena->strings_size = size;
+
+    return 0;
+}
+
+
+/** Get an arena copy of a string shared with all equal strings.
+ *
+ * @param arena
+ *      arena.
+ *
+ * @param str
+ *      string to be interned.
+ *
+ * @return
+ *      interned string or NULL on error. It must not be modified.
+ */
+const char *
+tz_arena_intern(struct tz_arena *arena, const char *str)
+{
+    size_t len;
+    size_t i;
+    char *copy;
+
+    if (2 * (arena->strings_count + 1) > arena->strings_size
+        && arena_strings_grow(arena) < 0)
+        return NULL;
+
+    i = arena_hash(str) & (arena->strings_size - 1);
+    while (arena->strings[i] != NULL) {
+        if (strcmp(arena->strings[i], str) == 0)
+            return arena->strings[i];
+        i = (i + 1) & (arena->strings_size - 1);
+    }
+
+    len = strlen(str) + 1;
+    if ((copy = (char *) tz_arena_alloc(arena, len)) == NULL)
+        return NULL;
+    memcpy(copy, str, len);
+
+    arena->strings[i] = copy;
+    arena->strings_count++;
+
+    return copy;
+}
+
+
+/** Release everything allocated from an arena.
+ * The biggest block is kept for reuse so that rebuilding a list of
+ * a similar size does not need to allocate any memory.
+ *
+ * @param arena
+ *      arena.
+ *
+ * @return
+ *      nothing.
+ */
+void
+tz_arena_reset(struct tz_arena *arena)
+{
+    struct tz_arena_block *block = arena->block;
+    struct tz_arena_block *prev;
+
+    if (block != NULL) {
+        prev = block->prev;
+        while (prev != NULL) {
+            block = prev;
+            prev = block->prev;
+            tz_mem_free(block);
+        }
+        block = arena->block;
+        block->prev = NULL;
+        block->used = 0;
+    }
+
+    tz_arena_init(arena);
+    arena->block = block;
+}
+
+
+/** Release an arena including all its memory.
+ *
+ * @param arena
+ *      arena.
+ *
+ * @return
+ *      nothing.
+ */
+void
+tz_arena_free(struct tz_arena *arena)
+{
+    struct tz_arena_block *block = arena->block;
+    struct tz_arena_block *prev;
+
+    while (block != NULL) {
+        prev = block->prev;
+        tz_mem_free(block);
+        block = prev;
+    }
+
+    tz_arena_init(arena);
+}
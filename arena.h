@@ -0,0 +1,56 @@
+/*
+ * Arena allocator for list-owned data.
+ * Copyright (C) 2026 Jiri Denemark
+ *
+ * This file is part of gkrellm-tz.
+ *
+ * gkrellm-tz is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/** @file
+ * Arena allocator for list-owned data.
+ * Memory is carved from a few large blocks and released all at once.
+ * Strings may be interned so that equal strings share a single copy.
+ * @author Jiri Denemark
+ */
+
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+
+
+struct tz_arena_block;
+
+/** Arena. */
+struct tz_arena {
+    /** The most recently allocated block, blocks are linked from it. */
+    struct tz_arena_block *block;
+    /** Hash table of interned strings (open addressing). */
+    const char **strings;
+    /** Number of slots in strings table, a power of two or zero. */
+    size_t strings_size;
+    /** Number of interned strings. */
+    size_t strings_count;
+};
+
+
+void tz_arena_init(struct tz_arena *arena);
+void *tz_arena_alloc(struct tz_arena *arena, size_t size);
+const char *tz_arena_intern(struct tz_arena *arena, const char *str);
+void tz_arena_reset(struct tz_arena *arena);
+void tz_arena_free(struct tz_arena *arena);
+
+#endif
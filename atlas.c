@@ -0,0 +1,430 @@
+/*
+ * Pre-rendered glyphs for drawing time strings.
+ * Copyright (C) 2026 Jiri Denemark
+ *
+ * This file is part of gkrellm-tz.
+ *
+ * gkrellm-tz is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/** @file
+ * Pre-rendered glyphs for drawing time strings.
+ * @author Jiri Denemark
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <glib.h>
+#include <gtk/gtk.h>
+#include <gkrellm2/gkrellm.h>
+
+#include "features.h"
+#include "atlas.h"
+#include "mem.h"
+
+
+/* Check whether Pango puts every glyph exactly where the advances of the
+ * preceding glyphs end, i.e., the font has no kerning and its advances are
+ * whole pixels. All pairs of glyphs are laid out next to each other and
+ * each position is checked, so errors cannot cancel each other out. */
+static int
+tz_atlas_exact(struct tz_atlas *atlas, PangoLayout *layout)
+{
+    PangoLayoutIter *iter;
+    PangoRectangle pos;
+    gchar *pairs;
+    gint expected = 0;
+    gint len = 0;
+    gint exact;
+    gint w;
+    gint h;
+    gint i;
+    gint j;
+
+    pairs = tz_mem_alloc(2 * TZ_ATLAS_GLYPHS * TZ_ATLAS_GLYPHS);
+    if (pairs == NULL)
+        return 0;
+
+    for (i = 0; i < TZ_ATLAS_GLYPHS; i++) {
+        for (j = 0; j < TZ_ATLAS_GLYPHS; j++) {
+            pairs[len++] = TZ_ATLAS_FIRST + i;
+            pairs[len++] = TZ_ATLAS_FIRST + j;
+        }
+    }
+
+    pango_layout_set_text(layout, pairs, len);
+    iter = pango_layout_get_iter(layout);
+    i = 0;
+    do {
+        pango_layout_iter_get_cluster_extents(iter, NULL, &pos);
+        for (; i < pango_layout_iter_get_index(iter); i++)
+            expected += atlas->width[pairs[i] - TZ_ATLAS_FIRST];
+        exact = pos.x == expected * PANGO_SCALE;
+    } while (exact && pango_layout_iter_next_cluster(iter));
+    pango_layout_iter_free(iter);
+
+    for (; i < len; i++)
+        expected += atlas->width[pairs[i] - TZ_ATLAS_FIRST];
+    pango_layout_get_pixel_size(layout, &w, &h);
+    tz_mem_free(pairs);
+
+    return exact && w == expected;
+}
+
+
+struct tz_atlas *
+tz_atlas_new(GkrellmTextstyle *text_style)
+{
+    struct tz_atlas *atlas;
+    GtkWidget *top;
+    PangoLayout *layout;
+    GdkGC *gc_mask;
+    GdkColor color;
+    gchar glyph[2];
+    gint effect;
+    gint width;
+    gint w;
+    gint h;
+    gint i;
+
+    top = gkrellm_get_top_window();
+    if (top == NULL || top->window == NULL || text_style == NULL)
+        return NULL;
+
+    atlas = (struct tz_atlas *) tz_mem_alloc(sizeof(struct tz_atlas));
+    if (atlas == NULL)
+        return NULL;
+    memset((void *) atlas, '\0', sizeof(struct tz_atlas));
+
+    atlas->text_style = text_style;
+    effect = (text_style->effect) ? 1 : 0;
+
+    layout = gtk_widget_create_pango_layout(top, NULL);
+    pango_layout_set_font_description(layout, text_style->font);
+
+    gkrellm_text_extents(text_style->font, "Yq", 2,
+                         &w, &h, NULL, &atlas->y_ink);
+
+    glyph[1] = '\0';
+    width = 0;
+    for (i = 0; i < TZ_ATLAS_GLYPHS; i++) {
+        glyph[0] = TZ_ATLAS_FIRST + i;
+        pango_layout_set_text(layout, glyph, 1);
+        pango_layout_get_pixel_size(layout, &w, &h);
+
+        atlas->x[i] = width;
+        atlas->width[i] = w;
+        width += w + effect;
+        if (h + effect > atlas->height)
+            atlas->height = h + effect;
+    }
+    atlas->exact = tz_atlas_exact(atlas, layout);
+
+    atlas->pixmap = gdk_pixmap_new(top->window, width, atlas->height, -1);
+    atlas->mask = gdk_pixmap_new(top->window, width, atlas->height, 1);
+    atlas->gc = gdk_gc_new(atlas->pixmap);
+    gc_mask = gdk_gc_new(atlas->mask);
+
+    /* antialiased edges are blended with what is already in the pixmap */
+    gdk_gc_set_rgb_fg_color(atlas->gc, &text_style->shadow_color);
+    gdk_draw_rectangle(atlas->pixmap, atlas->gc, TRUE,
+                       0, 0, width, atlas->height);
+
+    color.pixel = 0;
+    gdk_gc_set_foreground(gc_mask, &color);
+    gdk_draw_rectangle(atlas->mask, gc_mask, TRUE,
+                       0, 0, width, atlas->height);
+    color.pixel = 1;
+    gdk_gc_set_foreground(gc_mask, &color);
+
+    for (i = 0; i < TZ_ATLAS_GLYPHS; i++) {
+        glyph[0] = TZ_ATLAS_FIRST + i;
+        pango_layout_set_text(layout, glyph, 1);
+
+        if (effect) {
+            gdk_gc_set_rgb_fg_color(atlas->gc, &text_style->shadow_color);
+            gdk_draw_layout(atlas->pixmap, atlas->gc,
+                            atlas->x[i] + 1, 1, layout);
+            gdk_draw_layout(atlas->mask, gc_mask,
+                            atlas->x[i] + 1, 1, layout);
+        }
+
+        gdk_gc_set_rgb_fg_color(atlas->gc, &text_style->color);
+        gdk_draw_layout(atlas->pixmap, atlas->gc, atlas->x[i], 0, layout);
+        gdk_draw_layout(atlas->mask, gc_mask, atlas->x[i], 0, layout);
+    }
+
+    g_object_unref(gc_mask);
+    g_object_unref(layout);
+
+    return atlas;
+}
+
+
+void
+tz_atlas_free(struct tz_atlas *atlas)
+{
+    if (atlas == NULL)
+        return;
+
+    g_object_unref(atlas->gc);
+    g_object_unref(atlas->mask);
+    g_object_unref(atlas->pixmap);
+    tz_mem_free(atlas);
+}
+
+
+int
+tz_atlas_usable(struct tz_atlas *atlas, const char *text)
+{
+    const unsigned char *p;
+
+    if (atlas == NULL || !atlas->exact)
+        return 0;
+
+    for (p = (const unsigned char *) text; *p != '\0'; p++) {
+        if (*p < TZ_ATLAS_FIRST || *p > TZ_ATLAS_LAST
+            || *p == '<' || *p == '&')
+            return 0;
+    }
+
+    return 1;
+}
+
+
+gint
+tz_atlas_width(struct tz_atlas *atlas, const char *text)
+{
+    const unsigned char *p;
+    gint width = 0;
+
+    for (p = (const unsigned char *) text; *p != '\0'; p++)
+        width += atlas->width[*p - TZ_ATLAS_FIRST];
+
+    if (atlas->text_style->effect)
+        width++;
+
+    return width;
+}
+
+
+/* Create a layer covering a text decal. */
+int
+tz_atlas_layer_new(struct tz_atlas_layer *layer,
+                   GkrellmPanel *panel,
+                   GkrellmDecal *decal)
+{
+    GtkWidget *top;
+
+    layer->pixmap = NULL;
+    layer->mask = NULL;
+    layer->gc = NULL;
+    layer->decal = NULL;
+
+    top = gkrellm_get_top_window();
+    if (top == NULL || top->window == NULL)
+        return -1;
+
+    layer->pixmap = gdk_pixmap_new(top->window, decal->w, decal->h, -1);
+    layer->mask = gdk_pixmap_new(top->window, decal->w, decal->h, 1);
+    layer->gc = gdk_gc_new(layer->mask);
+    tz_atlas_layer_clear(layer);
+
+    layer->decal = gkrellm_create_decal_pixmap(panel, layer->pixmap,
+                                               layer->mask, 1, NULL,
+                                               decal->x, decal->y);
+    return 0;
+}
+
+
+/* The decal is destroyed with its panel, only the pixmaps are freed. */
+void
+tz_atlas_layer_free(struct tz_atlas_layer *layer)
+{
+    if (layer->pixmap == NULL)
+        return;
+
+    g_object_unref(layer->gc);
+    g_object_unref(layer->mask);
+    g_object_unref(layer->pixmap);
+    layer->pixmap = NULL;
+    layer->mask = NULL;
+    layer->gc = NULL;
+    layer->decal = NULL;
+}
+
+
+/* Remove all glyphs from a layer (they stay in the panel until it is
+ * redrawn from its layers). */
+void
+tz_atlas_layer_clear(struct tz_atlas_layer *layer)
+{
+    GdkColor color;
+    gint w;
+    gint h;
+
+    if (layer->mask == NULL)
+        return;
+
+    gdk_drawable_get_size(layer->mask, &w, &h);
+    color.pixel = 0;
+    gdk_gc_set_function(layer->gc, GDK_COPY);
+    gdk_gc_set_foreground(layer->gc, &color);
+    gdk_draw_rectangle(layer->mask, layer->gc, TRUE, 0, 0, w, h);
+}
+
+
+/* Redraw text in the part of a decal between left and right (absolute
+ * panel coordinates) and expose just that part. */
+static void
+tz_atlas_span(struct tz_atlas *atlas,
+              GkrellmPanel *panel,
+              GkrellmDecal *decal,
+              struct tz_atlas_layer *layer,
+              gint offset,
+              const char *text,
+              gint left,
+              gint right)
+{
+    const unsigned char *p;
+    gint effect = (atlas->text_style->effect) ? 1 : 0;
+    gint h = MIN(decal->h, atlas->height - atlas->y_ink);
+    GdkColor color;
+    gint x;
+    gint a;
+    gint b;
+    gint i;
+
+    left = MAX(left, decal->x);
+    right = MIN(right, decal->x + decal->w);
+    if (left >= right)
+        return;
+
+    /* restore background under the span */
+    gdk_gc_set_clip_mask(atlas->gc, NULL);
+    gdk_draw_drawable(panel->pixmap, atlas->gc, panel->bg_pixmap,
+                      left, decal->y, left, decal->y,
+                      right - left, decal->h);
+
+    /* glyphs are added to the mask of the layer one by one, shadows of
+     * neighbouring glyphs overlap */
+    color.pixel = 0;
+    gdk_gc_set_function(layer->gc, GDK_COPY);
+    gdk_gc_set_foreground(layer->gc, &color);
+    gdk_draw_rectangle(layer->mask, layer->gc, TRUE,
+                       left - decal->x, 0, right - left, decal->h);
+    gdk_gc_set_function(layer->gc, GDK_OR);
+
+    x = decal->x + offset;
+    gdk_gc_set_clip_mask(atlas->gc, atlas->mask);
+
+    for (p = (const unsigned char *) text; *p != '\0' && x < right; p++) {
+        i = *p - TZ_ATLAS_FIRST;
+
+        /* glyphs (and their shadows) are only drawn within the span */
+        a = MAX(x, left);
+        b = MIN(x + atlas->width[i] + effect, right);
+        if (a < b) {
+            gdk_gc_set_clip_origin(atlas->gc,
+                                   x - atlas->x[i],
+                                   decal->y - atlas->y_ink);
+            gdk_draw_drawable(panel->pixmap, atlas->gc, atlas->pixmap,
+                              atlas->x[i] + a - x, atlas->y_ink,
+                              a, decal->y, b - a, h);
+
+            gdk_gc_set_clip_origin(atlas->gc,
+                                   x - decal->x - atlas->x[i],
+                                   -atlas->y_ink);
+            gdk_draw_drawable(layer->pixmap, atlas->gc, atlas->pixmap,
+                              atlas->x[i] + a - x, atlas->y_ink,
+                              a - decal->x, 0, b - a, h);
+            gdk_draw_drawable(layer->mask, layer->gc, atlas->mask,
+                              atlas->x[i] + a - x, atlas->y_ink,
+                              a - decal->x, 0, b - a, h);
+        }
+
+        x += atlas->width[i];
+    }
+
+    gdk_gc_set_clip_mask(atlas->gc, NULL);
+
+    if (panel->drawing_area->window != NULL) {
+        gdk_draw_drawable(panel->drawing_area->window, atlas->gc,
+                          panel->pixmap, left, decal->y,
+                          left, decal->y, right - left, decal->h);
+    }
+}
+
+
+void
+tz_atlas_draw(struct tz_atlas *atlas,
+              GkrellmPanel *panel,
+              GkrellmDecal *decal,
+              struct tz_atlas_layer *layer,
+              gint offset,
+              const char *text)
+{
+    tz_atlas_span(atlas, panel, decal, layer, offset, text,
+                  decal->x, decal->x + decal->w);
+}
+
+
+/* Redraw only the glyphs which differ from the previously drawn text. The
+ * common prefix is never touched, the common suffix only if the changed
+ * parts are equally wide and thus the suffix did not move. */
+void
+tz_atlas_update(struct tz_atlas *atlas,
+                GkrellmPanel *panel,
+                GkrellmDecal *decal,
+                struct tz_atlas_layer *layer,
+                gint offset,
+                const char *text,
+                const char *previous)
+{
+    const unsigned char *p = (const unsigned char *) text;
+    const unsigned char *q = (const unsigned char *) previous;
+    gint left = decal->x + offset;
+    gint right;
+    gint width_new;
+    gint width_old;
+    size_t len_new;
+    size_t len_old;
+
+    while (*p != '\0' && *p == *q) {
+        left += atlas->width[*p - TZ_ATLAS_FIRST];
+        p++;
+        q++;
+    }
+    if (*p == '\0' && *q == '\0')
+        return;
+
+    len_new = strlen((const char *) p);
+    len_old = strlen((const char *) q);
+    width_new = tz_atlas_width(atlas, (const char *) p);
+    width_old = tz_atlas_width(atlas, (const char *) q);
+    right = left + MAX(width_new, width_old);
+
+    if (width_new == width_old) {
+        while (len_new > 0 && len_old > 0
+               && p[len_new - 1] == q[len_old - 1]) {
+            len_new--;
+            len_old--;
+            right -= atlas->width[p[len_new] - TZ_ATLAS_FIRST];
+        }
+    }
+
+    tz_atlas_span(atlas, panel, decal, layer, offset, text, left, right);
+}
@@ -0,0 +1,112 @@
+/*
+ * Pre-rendered glyphs for drawing time strings.
+ * Copyright (C) 2026 Jiri Denemark
+ *
+ * This file is part of gkrellm-tz.
+ *
+ * gkrellm-tz is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/** @file
+ * Pre-rendered glyphs for drawing time strings.
+ * @author Jiri Denemark
+ */
+
+#ifndef ATLAS_H
+#define ATLAS_H
+
+#include <gtk/gtk.h>
+#include <gkrellm2/gkrellm.h>
+
+/** The first character contained in an atlas. */
+#define TZ_ATLAS_FIRST  ' '
+/** The last character contained in an atlas. */
+#define TZ_ATLAS_LAST   '~'
+/** Number of glyphs in an atlas. */
+#define TZ_ATLAS_GLYPHS (TZ_ATLAS_LAST - TZ_ATLAS_FIRST + 1)
+
+
+/** Glyph atlas.
+ * All printable ASCII characters rendered once in a given text style into
+ * a single pixmap, so that time strings may be composed by copying glyphs
+ * instead of laying them out by Pango every time they change. Composed
+ * strings only look the same as those laid out by Pango if the font has
+ * no kerning and whole pixel advances, otherwise the atlas is not used.
+ */
+struct tz_atlas {
+    /** Text style the atlas was rendered in. */
+    GkrellmTextstyle *text_style;
+    /** Rendered glyphs next to each other. */
+    GdkPixmap *pixmap;
+    /** Mask of the glyphs' pixels. */
+    GdkBitmap *mask;
+    /** GC used for copying glyphs into panels. */
+    GdkGC *gc;
+    /** Height of the atlas. */
+    gint height;
+    /** Number of empty lines above the glyphs (see gkrellm_text_extents). */
+    gint y_ink;
+    /** Horizontal position of each glyph in the atlas. */
+    gint x[TZ_ATLAS_GLYPHS];
+    /** Advance width of each glyph. */
+    gint width[TZ_ATLAS_GLYPHS];
+    /** Nonzero if any string composed from the glyphs is as wide as when
+     * laid out by Pango. */
+    int exact;
+};
+
+
+/** Glyphs composed over a text decal.
+ * Glyphs are copied both directly into the panel and into a pixmap decal
+ * covering the text decal, so that they are drawn again whenever GKrellM
+ * redraws the panel from its layers. The pixmap and mask belong to the
+ * layer, the decal to the panel.
+ */
+struct tz_atlas_layer {
+    /** Composed glyphs. */
+    GdkPixmap *pixmap;
+    /** Mask of the composed glyphs' pixels, empty when nothing is drawn. */
+    GdkBitmap *mask;
+    /** GC used for drawing into the mask. */
+    GdkGC *gc;
+    /** Pixmap decal showing the glyphs. */
+    GkrellmDecal *decal;
+};
+
+
+struct tz_atlas *tz_atlas_new(GkrellmTextstyle *text_style);
+void tz_atlas_free(struct tz_atlas *atlas);
+int tz_atlas_usable(struct tz_atlas *atlas, const char *text);
+gint tz_atlas_width(struct tz_atlas *atlas, const char *text);
+int tz_atlas_layer_new(struct tz_atlas_layer *layer,
+                       GkrellmPanel *panel,
+                       GkrellmDecal *decal);
+void tz_atlas_layer_free(struct tz_atlas_layer *layer);
+void tz_atlas_layer_clear(struct tz_atlas_layer *layer);
+void tz_atlas_draw(struct tz_atlas *atlas,
+                   GkrellmPanel *panel,
+                   GkrellmDecal *decal,
+                   struct tz_atlas_layer *layer,
+                   gint offset,
+                   const char *text);
+void tz_atlas_update(struct tz_atlas *atlas,
+                     GkrellmPanel *panel,
+                     GkrellmDecal *decal,
+                     struct tz_atlas_layer *layer,
+                     gint offset,
+                     const char *text,
+                     const char *previous);
+
+#endif
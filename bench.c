@@ -0,0 +1,624 @@
+/*
+ * Self-checks and benchmarks of the conversion engine.
+ * Copyright (C) 2026 Jiri Denemark
+ *
+ * This file is part of gkrellm-tz.
+ *
+ * gkrellm-tz is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+/** @file
+ * Self-checks and benchmarks of the conversion engine.
+ * @author Jiri Denemark
+ */
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "arena.h"
+#include "civil.h"
+#include "format.h"
+#include "options.h"
+#include "item.h"
+#include "mem.h"
+#include "bench.h"
+
+/** Seconds per day. */
+#define DAY         86400L
+/** Number of zones converted at once by benchmarks of batches. */
+#define BENCH_BATCH 64
+/** Number of operations measured by each benchmark. */
+#define BENCH_OPS   2000000L
+
+/** Offsets used by checks, including the extremes of POSIX TZ rules. */
+static const long check_offsets[] = {
+    -89999, -86400, -50400, -12600, -3600, 0, 3600, 19800, 45900, 50400,
+    86399, 89999
+};
+#define CHECK_OFFSETS   (sizeof(check_offsets) / sizeof(check_offsets[0]))
+
+/** Seconds of a day used by checks. */
+static const long check_seconds[] = { 0, 1, 3599, 43200, 86399 };
+#define CHECK_SECONDS   (sizeof(check_seconds) / sizeof(check_seconds[0]))
+
+/** Timezones used by checks of renderers, with DST, half and quarter
+ * hour offsets, and a half hour DST shift. */
+static const char *check_zones[] = {
+    "UTC", "Europe/Prague", "America/New_York", "America/St_Johns",
+    "Asia/Kathmandu", "Australia/Lord_Howe"
+};
+#define CHECK_ZONES     (sizeof(check_zones) / sizeof(check_zones[0]))
+
+/** Built-in short formats (see tz_format_renderer). */
+static const char *check_formats[] = {
+    TZ_SHORT_FORMAT_24s, TZ_SHORT_FORMAT_24,
+    TZ_SHORT_FORMAT_12s, TZ_SHORT_FORMAT_12
+};
+#define CHECK_FORMATS   (sizeof(check_formats) / sizeof(check_formats[0]))
+
+/** Step (seconds) of checks of renderers, it walks through all hours,
+ * minutes and seconds of day in and out of DST. */
+#define CHECK_STEP      36007
+
+/** Formats used by checks of parallel conversion, a built-in one and one
+ * formatted by strftime with fractional seconds. */
+static const char *check_part_formats[] = {
+    TZ_SHORT_FORMAT_24s, "%a %d %b %T.%f %Z"
+};
+#define CHECK_PART_FORMATS \
+    (sizeof(check_part_formats) / sizeof(check_part_formats[0]))
+
+/** Range of time used by checks of parallel conversion (2020--2029). */
+#define CHECK_PART_FROM     1577836800L
+#define CHECK_PART_UNTIL    1893456000L
+/** Step (seconds) between ranges converted by checks of parallel
+ * conversion, ranges around transitions are always converted. */
+#define CHECK_PART_STEP     (7 * DAY + 3607)
+
+
+/** Part of items converted by a thread (see tz_check_parts). */
+struct check_part {
+    /** Timezones of the part. */
+    struct tz_item *const *items;
+    /** Their offsets. */
+    const long *gmtoff;
+    /** Space for their broken-down time. */
+    struct tm *tm;
+    /** Number of timezones. */
+    int count;
+    /** The first second to convert. */
+    time_t from;
+    /** The first second after the range. */
+    time_t until;
+    /** Renderer. */
+    enum tz_render render;
+    /** Prepared format. */
+    const char *format;
+    /** Period of the format. */
+    int period;
+};
+
+
+/** Time elapsed since a given moment in nanoseconds. */
+static double
+bench_elapsed(const struct timespec *start)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start->tv_sec) * 1e9
+           + (now.tv_nsec - start->tv_nsec);
+}
+
+
+/** Compare broken-down time computed by the engine with the C library. */
+static int
+check_tm(const struct tm *tm, const struct tm *expected, long gmtoff)
+{
+    return tm->tm_year == expected->tm_year
+           && tm->tm_mon == expected->tm_mon
+           && tm->tm_mday == expected->tm_mday
+           && tm->tm_hour == expected->tm_hour
+           && tm->tm_min == expected->tm_min
+           && tm->tm_sec == expected->tm_sec
+           && tm->tm_wday == expected->tm_wday
+           && tm->tm_yday == expected->tm_yday
+           && tm->tm_gmtoff == gmtoff;
+}
+
+
+/** Check civil date arithmetic against gmtime_r.
+ * Every day within the given number of years around the epoch is checked
+ * at several times of the day, each shifted by a set of offsets from UTC,
+ * both by tz_civil_tm and tz_civil_batch.
+ *
+ * @param years
+ *      how many years before and after 1970 to check.
+ *
+ * @return
+ *      number of mismatches (the first few are reported on stderr).
+ */
+long
+tz_check_civil(long years)
+{
+    struct tm batch[CHECK_OFFSETS];
+    struct tm expected;
+    struct tm tm;
+    long days = years * 146097 / 400;
+    long mismatches = 0;
+    long checked = 0;
+    time_t t;
+    time_t local;
+    long day;
+    size_t s;
+    size_t i;
+
+    for (day = -days; day <= days; day++) {
+        for (s = 0; s < CHECK_SECONDS; s++) {
+            t = day * DAY + check_seconds[s];
+            tz_civil_batch(t, CHECK_OFFSETS, check_offsets, batch);
+
+            for (i = 0; i < CHECK_OFFSETS; i++) {
+                local = t + check_offsets[i];
+                gmtime_r(&local, &expected);
+                tz_civil_tm(t, check_offsets[i], &tm);
+                checked += 2;
+
+                if (check_tm(&tm, &expected, check_offsets[i])
+                    && check_tm(batch + i, &expected, check_offsets[i]))
+                    continue;
+
+                if (mismatches++ < 10) {
+                    fprintf(stderr, "civil mismatch at %ld%+ld\n",
+                            (long) t, check_offsets[i]);
+                }
+            }
+        }
+    }
+
+    printf("civil checked\t%ld\n", checked);
+    printf("civil mismatches\t%ld\n", mismatches);
+
+    return mismatches;
+}
+
+
+/** Check built-in renderers of short time strings against strftime.
+ * Local times of several timezones within the given number of years
+ * around the epoch are computed by localtime_r, so they cover all times
+ * of day and timezone abbreviations in and out of DST, and rendered by
+ * both.
+ *
+ * @param years
+ *      how many years before and after 1970 to check.
+ *
+ * @return
+ *      number of mismatches (the first few are reported on stderr).
+ */
+long
+tz_check_render(long years)
+{
+    enum tz_render renderers[CHECK_FORMATS];
+    char expected[TZ_SHORT];
+    char str[TZ_SHORT];
+    struct tm tm;
+    time_t limit = years * 146097 / 400 * DAY;
+    long mismatches = 0;
+    long checked = 0;
+    time_t t;
+    size_t z;
+    size_t f;
+
+    for (f = 0; f < CHECK_FORMATS; f++)
+        renderers[f] = tz_format_renderer(check_formats[f]);
+
+    for (z = 0; z < CHECK_ZONES; z++) {
+        setenv("TZ", check_zones[z], 1);
+        tzset();
+
+        for (t = -limit; t <= limit; t += CHECK_STEP) {
+            localtime_r(&t, &tm);
+
+            for (f = 0; f < CHECK_FORMATS; f++) {
+                if (renderers[f] == TZ_RENDER_STRFTIME)
+                    continue;
+
+                tz_format_render(renderers[f], str, &tm);
+                strftime(expected, TZ_SHORT, check_formats[f], &tm);
+                checked++;
+
+                if (strcmp(str, expected) == 0)
+                    continue;
+
+                if (mismatches++ < 10) {
+                    fprintf(stderr,
+                            "%s at %ld: \"%s\" instead of \"%s\"\n",
+                            check_zones[z], (long) t, str, expected);
+                }
+            }
+        }
+    }
+    unsetenv("TZ");
+    tzset();
+
+    printf("render checked\t%ld\n", checked);
+    printf("render mismatches\t%ld\n", mismatches);
+
+    return mismatches;
+}
+
+
+static void *
+check_part_main(void *data)
+{
+    struct check_part *part = data;
+
+    tz_item_convert(part->items, part->gmtoff, part->tm, part->count,
+                    part->from, part->until, 0, part->render, part->format,
+                    part->period);
+
+    return NULL;
+}
+
+
+/** Convert all items either by the calling thread or split into parts
+ * converted in parallel, the same way the plugin does.
+ *
+ * @return
+ *      0 on success, -1 if threads could not be created.
+ */
+static int
+check_parts_convert(struct check_part *all, int threads)
+{
+    struct check_part part[TZ_THREADS_MAX];
+    pthread_t thread[TZ_THREADS_MAX];
+    int parts = tz_item_parts(all->count, threads);
+    int started;
+    int first;
+    int i;
+
+    for (i = 0; i < parts; i++) {
+        first = tz_item_part(all->count, parts, i);
+        part[i] = *all;
+        part[i].items += first;
+        part[i].gmtoff += first;
+        part[i].tm += first;
+        part[i].count = tz_item_part(all->count, parts, i + 1) - first;
+    }
+
+    for (started = 1; started < parts; started++) {
+        if (pthread_create(thread + started, NULL,
+                           check_part_main, part + started) != 0)
+            break;
+    }
+
+    check_part_main(part);
+    for (i = 1; i < started; i++)
+        pthread_join(thread[i], NULL);
+
+    return (started == parts) ? 0 : -1;
+}
+
+
+/** Check time strings converted by several threads in parallel are the
+ * same as those converted by a single thread. Timezones used by other
+ * checks are repeated to fill each thread with more than TZ_PART_MIN of
+ * them and their strings are converted for ranges of TZ_RING seconds
+ * spread over a decade, including every transition of local time type.
+ *
+ * @param threads
+ *      number of threads (2 ... TZ_THREADS_MAX).
+ *
+ * @return
+ *      number of mismatches (the first few are reported on stderr) or -1
+ *      on error.
+ */
+long
+tz_check_parts(int threads)
+{
+    struct tz_arena arena;
+    struct check_part all;
+    struct tz_item *items = NULL;
+    struct tz_item **ptrs = NULL;
+    struct tz_times *single = NULL;
+    struct tz_times *parallel = NULL;
+    time_t *next = NULL;
+    long *gmtoff = NULL;
+    struct tm *tm = NULL;
+    char format[TZ_FORMAT];
+    int count = TZ_PART_MIN * threads + CHECK_ZONES + 1;
+    long mismatches = 0;
+    long checked = 0;
+    time_t from;
+    time_t until;
+    time_t edge;
+    time_t t;
+    size_t f;
+    int i;
+
+    tz_arena_init(&arena);
+    items = tz_mem_alloc(count * sizeof(*items));
+    ptrs = tz_mem_alloc(count * sizeof(*ptrs));
+    single = tz_mem_alloc(count * TZ_RING * sizeof(*single));
+    parallel = tz_mem_alloc(count * TZ_RING * sizeof(*parallel));
+    next = tz_mem_alloc(count * sizeof(*next));
+    gmtoff = tz_mem_alloc(count * sizeof(*gmtoff));
+    tm = tz_mem_alloc(count * sizeof(*tm));
+    if (items == NULL || ptrs == NULL || single == NULL || parallel == NULL
+        || next == NULL || gmtoff == NULL || tm == NULL) {
+        mismatches = -1;
+        goto cleanup;
+    }
+
+    for (i = 0; i < count; i++) {
+        tz_item_init(items + i);
+        ptrs[i] = items + i;
+        items[i].timezone = check_zones[i % CHECK_ZONES];
+        if (i >= (int) CHECK_ZONES) {
+            items[i].tzfile = items[i % CHECK_ZONES].tzfile;
+            continue;
+        }
+        if ((items[i].tzfile = tz_tzfile_load(&arena, check_zones[i])) == NULL)
+            fprintf(stderr, "cannot load timezone %s\n", check_zones[i]);
+    }
+
+    all.items = ptrs;
+    all.gmtoff = gmtoff;
+    all.tm = tm;
+    all.count = count;
+
+    for (f = 0; f < CHECK_PART_FORMATS; f++) {
+        tz_format_prepare(check_part_formats[f], format, TZ_FORMAT);
+        all.render = tz_format_renderer(check_part_formats[f]);
+        all.format = format;
+        all.period = tz_format_period(format);
+
+        for (i = 0; i < count; i++)
+            memset(&items[i].zone, '\0', sizeof(items[i].zone));
+
+        for (from = CHECK_PART_FROM; from < CHECK_PART_UNTIL; ) {
+            until = from + TZ_RING;
+            edge = from + CHECK_PART_STEP;
+            for (i = 0; i < count; i++) {
+                tz_item_zone(items + i, from);
+                gmtoff[i] = items[i].zone.gmtoff;
+                if (items[i].zone.until < until)
+                    until = items[i].zone.until;
+                else if (items[i].zone.until < edge)
+                    edge = items[i].zone.until - TZ_RING / 2;
+                next[i] = items[i].next = from;
+            }
+            all.from = from;
+            all.until = until;
+
+            for (i = 0; i < count; i++)
+                items[i].ring = single + i * TZ_RING;
+            check_parts_convert(&all, 1);
+
+            for (i = 0; i < count; i++) {
+                items[i].ring = parallel + i * TZ_RING;
+                items[i].next = next[i];
+            }
+            if (check_parts_convert(&all, threads) < 0) {
+                mismatches = -1;
+                goto cleanup;
+            }
+
+            for (i = 0; i < count; i++) {
+                for (t = from; t < until; t++) {
+                    struct tz_times *a = single + i * TZ_RING
+                                         + tz_item_slot(t);
+                    struct tz_times *b = parallel + i * TZ_RING
+                                         + tz_item_slot(t);
+
+                    checked++;
+                    if (strcmp(a->time_short, b->time_short) == 0
+                        && a->zone.gmtoff == b->zone.gmtoff)
+                        continue;
+
+                    if (mismatches++ < 10) {
+                        fprintf(stderr,
+                                "%s at %ld: \"%s\" instead of \"%s\"\n",
+                                items[i].timezone, (long) t,
+                                b->time_short, a->time_short);
+                    }
+                }
+            }
+
+            /* a range stops at a transition, the next one starts there */
+            if (until < from + TZ_RING)
+                from = until;
+            else if (edge > until)
+                from = edge;
+            else
+                from = until;
+        }
+    }
+
+    printf("parts checked\t%ld\n", checked);
+    printf("parts mismatches\t%ld\n", mismatches);
+
+cleanup:
+    tz_mem_free(tm);
+    tz_mem_free(gmtoff);
+    tz_mem_free(next);
+    tz_mem_free(parallel);
+    tz_mem_free(single);
+    tz_mem_free(ptrs);
+    tz_mem_free(items);
+    tz_arena_free(&arena);
+
+    return mismatches;
+}
+
+
+/** Measure the cost of converting a time to broken-down local time by the
+ * C library and by the engine.
+ *
+ * @param out
+ *      where to print the results (ns per conversion).
+ *
+ * @return
+ *      nothing.
+ */
+void
+tz_bench_civil(FILE *out)
+{
+    struct tm tm[BENCH_BATCH];
+    long gmtoff[BENCH_BATCH];
+    struct timespec start;
+    volatile int sink = 0;
+    time_t base = 1700000000;
+    time_t t;
+    long n;
+    int i;
+
+    for (i = 0; i < BENCH_BATCH; i++)
+        gmtoff[i] = (i % 27 - 13) * 3600L + (i % 4) * 900L;
+
+    setenv("TZ", "Europe/Prague", 1);
+    tzset();
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (n = 0; n < BENCH_OPS; n++) {
+        t = base + n * 7;
+        localtime_r(&t, tm);
+        sink += tm->tm_mday;
+    }
+    fprintf(out, "localtime_r\t%.1f\n", bench_elapsed(&start) / BENCH_OPS);
+    unsetenv("TZ");
+    tzset();
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (n = 0; n < BENCH_OPS; n++) {
+        t = base + n * 7 + gmtoff[n % BENCH_BATCH];
+        gmtime_r(&t, tm);
+        sink += tm->tm_mday;
+    }
+    fprintf(out, "gmtime_r\t%.1f\n", bench_elapsed(&start) / BENCH_OPS);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (n = 0; n < BENCH_OPS; n++) {
+        tz_civil_tm(base + n * 7, gmtoff[n % BENCH_BATCH], tm);
+        sink += tm->tm_mday;
+    }
+    fprintf(out, "tz_civil_tm\t%.1f\n", bench_elapsed(&start) / BENCH_OPS);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (n = 0; n < BENCH_OPS; n += BENCH_BATCH) {
+        tz_civil_batch(base + n * 7, BENCH_BATCH, gmtoff, tm);
+        sink += tm[n % BENCH_BATCH].tm_mday;
+    }
+    fprintf(out, "tz_civil_batch\t%.1f\n",
+            bench_elapsed(&start) / BENCH_OPS);
+}
+
+
+/** Measure the cost of a sub-second update of one panel, i.e., rewriting
+ * fractional second digits in place, and how many of such updates at
+ * 100 Hz actually change the string (only those panels are redrawn).
+ *
+ * @param out
+ *      where to print the results.
+ *
+ * @return
+ *      nothing.
+ */
+void
+tz_bench_frac(FILE *out)
+{
+    static const char *formats[] = { "%T.%1f %Z", "%T.%f %Z", "%T.%6f %Z" };
+    struct tz_frac frac[TZ_FRAC];
+    char format[TZ_FORMAT];
+    char str[TZ_SHORT];
+    struct timespec start;
+    struct tm tm;
+    time_t t = 1700000000;
+    long changed;
+    long n;
+    int count;
+    size_t i;
+
+    tz_civil_tm(t, 0, &tm);
+    tm.tm_zone = "UTC";
+
+    for (i = 0; i < sizeof(formats) / sizeof(formats[0]); i++) {
+        tz_format_prepare(formats[i], format, TZ_FORMAT);
+        strftime(str, TZ_SHORT, format, &tm);
+        count = tz_format_frac_find(str, frac);
+
+        changed = 0;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for (n = 0; n < BENCH_OPS; n++) {
+            /* 100 Hz ticks */
+            changed += tz_format_frac_set(str, frac, count,
+                                          n % 100 * 10000000L);
+        }
+        fprintf(out, "frac %s\t%.1f\t%.0f%% redrawn\n", formats[i],
+                bench_elapsed(&start) / BENCH_OPS,
+                100.0 * changed / BENCH_OPS);
+    }
+}
+
+
+/** Measure the cost of rendering built-in short formats by strftime and
+ * by the built-in renderers.
+ *
+ * @param out
+ *      where to print the results (ns per string).
+ *
+ * @return
+ *      nothing.
+ */
+void
+tz_bench_render(FILE *out)
+{
+    enum tz_render renderer;
+    struct tm tm[BENCH_BATCH];
+    char str[TZ_SHORT];
+    struct timespec start;
+    double strftime_ns;
+    long n;
+    size_t f;
+    int i;
+
+    for (i = 0; i < BENCH_BATCH; i++) {
+        tz_civil_tm(1700000000 + i * 4001L, 0, tm + i);
+        tm[i].tm_zone = (i % 2) ? "CEST" : "CET";
+    }
+
+    for (f = 0; f < CHECK_FORMATS; f++) {
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for (n = 0; n < BENCH_OPS; n++)
+            strftime(str, TZ_SHORT, check_formats[f], tm + n % BENCH_BATCH);
+        strftime_ns = bench_elapsed(&start) / BENCH_OPS;
+
+        renderer = tz_format_renderer(check_formats[f]);
+        if (renderer == TZ_RENDER_STRFTIME) {
+            fprintf(out, "render %s\t%.1f\tstrftime\n",
+                    check_formats[f], strftime_ns);
+            continue;
+        }
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for (n = 0; n < BENCH_OPS; n++)
+            tz_format_render(renderer, str, tm + n % BENCH_BATCH);
+        fprintf(out, "render %s\t%.1f\t%.1f\n", check_formats[f],
+                strftime_ns, bench_elapsed(&start) / BENCH_OPS);
+    }
+}
@@ -0,0 +1,44 @@
+/*
+ * Self-checks and benchmarks of the conversion engine.
+ * Copyright (C) 2026 Jiri Denemark
+ *
+ * This file is part of gkrellm-tz.
+ *
+ * gkrellm-tz is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+/** @file
+ * Self-checks and benchmarks of the conversion engine.
+ * Checks compare the engine with the C library over ranges of time,
+ * benchmarks measure the cost of the engine's building blocks against
+ * the C library routines they replace. Both are run by gkrellm-tz-convert
+ * (-K and -B) and by "make check".
+ * @author Jiri Denemark
+ */
+
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stdio.h>
+
+long tz_check_civil(long years);
+long tz_check_render(long years);
+long tz_check_parts(int threads);
+void tz_bench_civil(FILE *out);
+void tz_bench_render(FILE *out);
+void tz_bench_frac(FILE *out);
+
+#endif
@@ -0,0 +1,295 @@
+/*
+ * Civil calendar arithmetic.
+ * Copyright (C) 2026 Jiri Denemark
+ *
+ * This file is part of gkrellm-tz.
+ *
+ * gkrellm-tz is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/** @file
+ * Civil calendar arithmetic.
+ * Days are converted to dates using the algorithm described by Howard
+ * Hinnant in "chrono-Compatible Low-Level Date Algorithms".
+ * @author Jiri Denemark
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+#include "civil.h"
+
+/** Number of zones converted at once by the batch kernel. */
+#define CIVIL_CHUNK     64
+/** Seconds per day. */
+#define DAY             86400
+
+/* Let GCC build both SSE2 and AVX2 versions of the batch kernel and pick
+ * one at load time. */
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 6 \
+    && defined(__x86_64__) && defined(__ELF__)
+# define CIVIL_KERNEL   __attribute__((target_clones("avx2", "default")))
+#else
+# define CIVIL_KERNEL
+#endif
+
+/** Days in a year before the first day of each month,
+ * indexed by [leap year][month]. */
+static const int16_t civil_days_before[2][12] = {
+    { 0, 31, 59, 90, 120, 151, 181, 212, 243, 273, 304, 334 },
+    { 0, 31, 60, 91, 121, 152, 182, 213, 244, 274, 305, 335 }
+};
+
+/** Day of week indexed by (days since epoch) % 7 + 6.
+ * 1970-01-01 was Thursday. */
+static const int8_t civil_wday[13] = {
+    5, 6, 0, 1, 2, 3, 4, 5, 6, 0, 1, 2, 3
+};
+
+
+/** Convert days since epoch into a civil date.
+ * This is branch-free and works on 32-bit integers only so that loops
+ * calling it can be vectorized.
+ *
+ * @param days
+ *      days since 1970-01-01.
+ *
+ * @param year
+ *      where to store the year.
+ *
+ * @param mon
+ *      where to store the month (0--11).
+ *
+ * @param mday
+ *      where to store the day of month (1--31).
+ *
+ * @param leap
+ *      where to store 1 for leap years, 0 otherwise.
+ *
+ * @return
+ *      nothing.
+ */
+static inline void
+civil_from_days(int32_t days,
+                int32_t *year,
+                int32_t *mon,
+                int32_t *mday,
+                int32_t *leap)
+{
+    int32_t z = days + 719468;
+    int32_t era = (z - (z < 0) * 146096) / 146097;
+    int32_t doe = z - era * 146097;
+    int32_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    int32_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    int32_t mp = (5 * doy + 2) / 153;
+    int32_t jan = mp >= 10;
+    int32_t y = yoe + era * 400 + jan;
+
+    *year = y;
+    *mon = mp + 2 - jan * 12;
+    *mday = doy - (153 * mp + 2) / 5 + 1;
+    *leap = ((y & 3) == 0) & ((y % 100 != 0) | (y % 400 == 0));
+}
+
+
+/** Convert days since epoch into civil dates.
+ *
+ * @param count
+ *      number of elements in all arrays (at most CIVIL_CHUNK).
+ *
+ * @param days
+ *      days since 1970-01-01.
+ *
+ * @param year
+ *      where to store years.
+ *
+ * @param mon
+ *      where to store months (0--11).
+ *
+ * @param mday
+ *      where to store days of month (1--31).
+ *
+ * @param leap
+ *      where to store leap year flags.
+ *
+ * @return
+ *      nothing.
+ */
+static void civil_kernel(int count,
+                         const int32_t *days,
+                         int32_t *year,
+                         int32_t *mon,
+                         int32_t *mday,
+                         int32_t *leap);
+
+
+/** Fill broken-down time from days and seconds since midnight.
+ *
+ * @param days
+ *      days since 1970-01-01.
+ *
+ * @param secs
+ *      seconds since midnight (0--86399).
+ *
+ * @param year
+ *      year.
+ *
+ * @param mon
+ *      month (0--11).
+ *
+ * @param mday
+ *      day of month (1--31).
+ *
+ * @param leap
+ *      1 for leap years, 0 otherwise.
+ *
+ * @param tm
+ *      where to store the result.
+ *
+ * @return
+ *      nothing.
+ */
+static inline void
+civil_fill(int32_t days,
+           int32_t secs,
+           int32_t year,
+           int32_t mon,
+           int32_t mday,
+           int32_t leap,
+           struct tm *tm)
+{
+    tm->tm_sec = secs % 60;
+    tm->tm_min = secs / 60 % 60;
+    tm->tm_hour = secs / 3600;
+    tm->tm_mday = mday;
+    tm->tm_mon = mon;
+    tm->tm_year = year - 1900;
+    tm->tm_wday = civil_wday[days % 7 + 6];
+    tm->tm_yday = civil_days_before[leap][mon] + mday - 1;
+}
+
+
+/** Convert a civil date into days since epoch.
+ * This is the inverse of civil_from_days.
+ *
+ * @param year
+ *      year.
+ *
+ * @param mon
+ *      month (0--11).
+ *
+ * @param mday
+ *      day of month (1--31).
+ *
+ * @return
+ *      days since 1970-01-01.
+ */
+long
+tz_civil_days(long year, int mon, int mday)
+{
+    long y = year - (mon < 2);
+    long era = ((y >= 0) ? y : y - 399) / 400;
+    long yoe = y - era * 400;
+    long mp = (mon + 10) % 12;
+    long doy = (153 * mp + 2) / 5 + mday - 1;
+    long doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+
+    return era * 146097 + doe - 719468;
+}
+
+
+void
+tz_civil_tm(time_t t, long gmtoff, struct tm *tm)
+{
+    time_t local = t + gmtoff;
+    int32_t days;
+    int32_t secs;
+    int32_t year;
+    int32_t mon;
+    int32_t mday;
+    int32_t leap;
+
+    days = local / DAY;
+    secs = local % DAY;
+    days -= secs < 0;
+    secs += (secs < 0) * DAY;
+
+    civil_from_days(days, &year, &mon, &mday, &leap);
+    civil_fill(days, secs, year, mon, mday, leap, tm);
+    tm->tm_gmtoff = gmtoff;
+}
+
+
+void
+tz_civil_batch(time_t t, int count, const long *gmtoff, struct tm *tm)
+{
+    int32_t days[CIVIL_CHUNK];
+    int32_t secs[CIVIL_CHUNK];
+    int32_t year[CIVIL_CHUNK];
+    int32_t mon[CIVIL_CHUNK];
+    int32_t mday[CIVIL_CHUNK];
+    int32_t leap[CIVIL_CHUNK];
+    int32_t tdays;
+    int32_t tsecs;
+    int n;
+    int i;
+
+    /* Split t into days and seconds once and only carry whole days per
+     * zone. Offsets of POSIX TZ rules may reach 24:59:59 (and timezone
+     * files allow anything fitting 32 bits), so the carry is a floor
+     * division rather than just the previous or the next day. */
+    tdays = t / DAY;
+    tsecs = t % DAY;
+    tdays -= tsecs < 0;
+    tsecs += (tsecs < 0) * DAY;
+
+    for (; count > 0; count -= n, gmtoff += n, tm += n) {
+        n = (count < CIVIL_CHUNK) ? count : CIVIL_CHUNK;
+
+        for (i = 0; i < n; i++) {
+            int32_t s = tsecs + (int32_t) gmtoff[i];
+            int32_t carry = s / DAY;
+
+            carry -= s - carry * DAY < 0;
+
+            secs[i] = s - carry * DAY;
+            days[i] = tdays + carry;
+        }
+
+        civil_kernel(n, days, year, mon, mday, leap);
+
+        for (i = 0; i < n; i++) {
+            civil_fill(days[i], secs[i], year[i], mon[i], mday[i], leap[i],
+                       tm + i);
+            tm[i].tm_gmtoff = gmtoff[i];
+        }
+    }
+}
+
+
+CIVIL_KERNEL static void
+civil_kernel(int count,
+             const int32_t *days,
+             int32_t *year,
+             int32_t *mon,
+             int32_t *mday,
+             int32_t *leap)
+{
+    int i;
+
+    for (i = 0; i < count; i++)
+        civil_from_days(days[i], year + i, mon + i, mday + i, leap + i);
+}
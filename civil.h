@@ -0,0 +1,36 @@
+/*
+ * Civil calendar arithmetic.
+ * Copyright (C) 2026 Jiri Denemark
+ *
+ * This file is part of gkrellm-tz.
+ *
+ * gkrellm-tz is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/** @file
+ * Civil calendar arithmetic.
+ * @author Jiri Denemark
+ */
+
+#ifndef CIVIL_H
+#define CIVIL_H
+
+#include <time.h>
+
+long tz_civil_days(long year, int mon, int mday);
+void tz_civil_tm(time_t t, long gmtoff, struct tm *tm);
+void tz_civil_batch(time_t t, int count, const long *gmtoff, struct tm *tm);
+
+#endif
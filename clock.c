@@ -0,0 +1,228 @@
+/*
+ * Time source.
+ * Copyright (C) 2026 Jiri Denemark
+ *
+ * This file is part of gkrellm-tz.
+ *
+ * gkrellm-tz is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/** @file
+ * Time source.
+ * @author Jiri Denemark
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <time.h>
+
+#include "clock.h"
+
+
+/** Currently used time source. */
+static struct {
+    /** Kind of the clock. */
+    enum tz_clock_mode mode;
+    /** Simulated time at start. */
+    struct timespec origin;
+    /** Real time at which the clock was set. */
+    struct timespec start;
+    /** How many times faster than real time the clock runs. */
+    long factor;
+} clock_source = { TZ_CLOCK_REAL, { 0, 0 }, { 0, 0 }, 1 };
+
+
+/** Get real time regardless of the selected time source.
+ * Unlike mktime(gkrellm_get_current_time()) this does not depend on local
+ * timezone (and thus is not ambiguous when DST ends) and keeps nanoseconds.
+ *
+ * @param now
+ *      where to store current time.
+ *
+ * @return
+ *      nothing.
+ */
+void
+tz_clock_real(struct timespec *now)
+{
+#ifdef CLOCK_REALTIME
+    if (clock_gettime(CLOCK_REALTIME, now) == 0)
+        return;
+#endif
+    {
+        struct timeval tv;
+
+        gettimeofday(&tv, NULL);
+        now->tv_sec = tv.tv_sec;
+        now->tv_nsec = tv.tv_usec * 1000;
+    }
+}
+
+
+/** Get current time from the selected time source (real time unless
+ * changed by tz_clock_set).
+ *
+ * @param now
+ *      where to store current time.
+ *
+ * @return
+ *      nothing.
+ */
+void
+tz_clock_now(struct timespec *now)
+{
+    struct timespec real;
+    long long elapsed;
+
+    switch (clock_source.mode) {
+    case TZ_CLOCK_FIXED:
+        *now = clock_source.origin;
+        break;
+
+    case TZ_CLOCK_FAST:
+        tz_clock_real(&real);
+        elapsed = ((long long) (real.tv_sec - clock_source.start.tv_sec)
+                   * 1000000000
+                   + real.tv_nsec - clock_source.start.tv_nsec)
+                  * clock_source.factor;
+        now->tv_sec = clock_source.origin.tv_sec + elapsed / 1000000000;
+        now->tv_nsec = clock_source.origin.tv_nsec + elapsed % 1000000000;
+        if (now->tv_nsec < 0) {
+            now->tv_sec--;
+            now->tv_nsec += 1000000000;
+        } else if (now->tv_nsec >= 1000000000) {
+            now->tv_sec++;
+            now->tv_nsec -= 1000000000;
+        }
+        break;
+
+    default:
+        tz_clock_real(now);
+    }
+}
+
+
+/** Select time source.
+ *
+ * @param mode
+ *      kind of the clock.
+ *
+ * @param origin
+ *      initial time of a simulated clock, NULL for current time.
+ *
+ * @param factor
+ *      speed of TZ_CLOCK_FAST clock relative to real time.
+ *
+ * @return
+ *      nothing.
+ */
+void
+tz_clock_set(enum tz_clock_mode mode,
+             const struct timespec *origin,
+             long factor)
+{
+    struct timespec now;
+
+    tz_clock_real(&now);
+
+    clock_source.mode = mode;
+    clock_source.origin = (origin != NULL) ? *origin : now;
+    clock_source.start = now;
+    clock_source.factor = (factor > 0) ? factor : 1;
+}
+
+
+/** Move fixed clock forward (or backward).
+ * Other clocks are not affected.
+ *
+ * @param sec
+ *      seconds to add.
+ *
+ * @param nsec
+ *      nanoseconds to add (0--999999999).
+ *
+ * @return
+ *      nothing.
+ */
+void
+tz_clock_advance(long sec, long nsec)
+{
+    if (clock_source.mode != TZ_CLOCK_FIXED)
+        return;
+
+    clock_source.origin.tv_sec += sec;
+    clock_source.origin.tv_nsec += nsec;
+    if (clock_source.origin.tv_nsec >= 1000000000) {
+        clock_source.origin.tv_sec++;
+        clock_source.origin.tv_nsec -= 1000000000;
+    }
+}
+
+
+/** Select time source according to its textual description:
+ * "real", "fixed:T", "fast:N", or "fast:N@T", where T is the initial time
+ * in seconds since epoch (current time if missing) and N is the speed
+ * relative to real time.
+ *
+ * @param spec
+ *      clock description, NULL selects real time.
+ *
+ * @return
+ *      0 on success, -1 if spec is invalid (the clock is not changed).
+ */
+int
+tz_clock_parse(const char *spec)
+{
+    struct timespec origin = { 0, 0 };
+    const char *p;
+    char *end;
+    long factor;
+
+    if (spec == NULL || *spec == '\0' || strcmp(spec, "real") == 0) {
+        tz_clock_set(TZ_CLOCK_REAL, NULL, 1);
+        return 0;
+    }
+
+    if (strncmp(spec, "fixed:", 6) == 0) {
+        origin.tv_sec = strtoll(spec + 6, &end, 10);
+        if (end == spec + 6 || *end != '\0')
+            return -1;
+        tz_clock_set(TZ_CLOCK_FIXED, &origin, 1);
+        return 0;
+    }
+
+    if (strncmp(spec, "fast:", 5) == 0) {
+        factor = strtol(spec + 5, &end, 10);
+        if (end == spec + 5 || factor <= 0)
+            return -1;
+
+        if (*end == '\0') {
+            tz_clock_set(TZ_CLOCK_FAST, NULL, factor);
+            return 0;
+        }
+
+        p = end + 1;
+        if (*end != '@')
+            return -1;
+        origin.tv_sec = strtoll(p, &end, 10);
+        if (end == p || *end != '\0')
+            return -1;
+        tz_clock_set(TZ_CLOCK_FAST, &origin, factor);
+        return 0;
+    }
+
+    return -1;
+}
@@ -0,0 +1,60 @@
+/*
+ * Time source.
+ * Copyright (C) 2026 Jiri Denemark
+ *
+ * This file is part of gkrellm-tz.
+ *
+ * gkrellm-tz is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+/** @file
+ * Time source.
+ * Current time may be replaced with a simulated clock which is either
+ * fixed (and only moves when advanced explicitly) or runs N times faster
+ * than real time, so that behaviour around DST transitions can be checked
+ * without waiting for them.
+ * @author Jiri Denemark
+ */
+
+#ifndef CLOCK_H
+#define CLOCK_H
+
+#include <time.h>
+
+/** Name of environment variable selecting the clock (see tz_clock_parse). */
+#define TZ_CLOCK_ENV    "GKRELLM_TZ_CLOCK"
+
+
+/** Kinds of time sources. */
+enum tz_clock_mode {
+    /** Real time. */
+    TZ_CLOCK_REAL,
+    /** Time stands still at origin unless advanced by tz_clock_advance. */
+    TZ_CLOCK_FIXED,
+    /** Time starts at origin and runs factor times faster than real time. */
+    TZ_CLOCK_FAST
+};
+
+
+void tz_clock_real(struct timespec *now);
+void tz_clock_now(struct timespec *now);
+void tz_clock_set(enum tz_clock_mode mode,
+                  const struct timespec *origin,
+                  long factor);
+void tz_clock_advance(long sec, long nsec);
+int tz_clock_parse(const char *spec);
+
+#endif
@@ -36,6 +36,14 @@
 
 #include "list.h"
 #include "config.h"
+#include "mem.h"
+
+/** Range of time travel scrubber in minutes (in both directions). */
+#define TRAVEL_RANGE    (14 * 24 * 60)
+/** Step of time travel scrubber in minutes. */
+#define TRAVEL_STEP     15
+/** File latency statistics are exported to (in GKrellM data directory). */
+#define STATS_FILE      "gkrellm-tz-latency"
 
 static gchar about_text[] =
     "gkrellm-tz " VERSION "\n"
@@ -61,12 +69,73 @@ static gchar *info_text[] = {
     "<b>Timezone\n",
     "\tTimezone identification as can be found under /usr/share/zoneinfo/.\n",
     "\tFor example, \"Europe/Prague\" or \"UTC\"\n",
+    "\tPOSIX TZ rules, e.g., \"EST5EDT,M3.2.0,M11.1.0\", are accepted too.\n",
+    "\tFixed offsets may be written as \"Etc/GMT-3\" or as TZ rules such as\n",
+    "\t\"UTC-3\" or \"UTC-05:30\"; as in POSIX, both are east of Greenwich.\n",
+    "<b>Search\n",
+    "\tOnly timezones whose label or timezone contains the given text are\n",
+    "\tlisted. Up and down buttons move a timezone among the listed ones.\n",
     "\n",
     "<b>Options Configuration\n",
     "<b>Custom time format\n",
     "\t\"Short\" format string is used for displaying time in panels.\n",
     "\t\"Long\" format string is used for tooltips.\n",
     "\tSee strftime(3) or date(1) man pages for format string specification.\n",
+    "\tIn addition, %f stands for milliseconds and %1f ... %9f for the given\n",
+    "\tnumber of fractional second digits.\n",
+    "<b>Fractional seconds redrawn\n",
+    "\tHow many times a second (10 ... 100) panels showing fractional seconds\n",
+    "\tare redrawn; 0 redraws them with every GKrellM update. Only the digits\n",
+    "\tare rewritten in place between full updates (no strftime or timezone\n",
+    "\twork), which takes 10-30 ns per panel (gkrellm-tz-convert -B). Only\n",
+    "\tpanels whose digits changed are redrawn, e.g., one in ten updates at\n",
+    "\t100 Hz for %1f. With pre-rendered glyphs only the changed digits are\n",
+    "\tdrawn, otherwise the whole panel is.\n",
+    "<b>Draw time from pre-rendered glyphs\n",
+    "\tPrinting characters are rendered once into a cache and time strings\n",
+    "\tare composed by copying them. Strings with pango markup or non-ASCII\n",
+    "\tcharacters are still drawn by Pango. So are all strings if the font\n",
+    "\tuses kerning or fractional advances since composing glyphs would not\n",
+    "\tplace them exactly where Pango does.\n",
+    "<b>Publish current times in shared memory\n",
+    "\tLabels, offsets and time strings of all enabled timezones are written\n",
+    "\tinto POSIX shared memory object /gkrellm-tz-UID once per update so\n",
+    "\tthat other programs may read them without running date(1). See shm.h\n",
+    "\tin gkrellm-tz sources for the layout and locking protocol.\n",
+    "<b>Timezones per page\n",
+    "\tWhen nonzero, only the given number of timezones is shown at once.\n",
+    "\tScrolling over the panels switches pages and pages may also be\n",
+    "\tswitched automatically every given number of seconds (0 disables\n",
+    "\tthat). Only timezones on the current page are updated and published.\n",
+    "<b>Threads converting long lists of timezones\n",
+    "\tTime strings of lists with hundreds of shown timezones are computed\n",
+    "\tby up to the given number of threads, each converting its own part of\n",
+    "\tthe list (at least 64 timezones). 1 keeps a single thread.\n",
+    "\n",
+    "<b>Meeting Planner\n",
+    "\tClicking a panel opens a grid of local hours of all enabled timezones.\n",
+    "\tBusiness hours (9--17, Mon--Fri) are green, night is grey, hours\n",
+    "\tcommon to all timezones are marked on top, red marks an offset\n",
+    "\tchange and + marks zones not aligned to whole hours. Scrolling or\n",
+    "\tthe buttons shift the grid.\n",
+    "\n",
+    "<b>Time Travel\n",
+    "\tPanels show all timezones at a chosen instant instead of now. Moving\n",
+    "\tthe slider shifts the shown time by up to two weeks, pinning stops it\n",
+    "\tat the given local date and time (YYYY-MM-DD HH:MM). Changes are shown\n",
+    "\timmediately, \"Now\" returns to the current time. Shared memory is not\n",
+    "\tupdated while time travelling.\n",
+    "\n",
+    "<b>Latency\n",
+    "\tShows how late after a second boundary the plugin starts updating\n",
+    "\tthe panels and finishes drawing them (median, 99th percentile, and\n",
+    "\tmaximum since GKrellM started or since Reset). Export writes the\n",
+    "\tfull histograms to ~/.gkrellm2/data/" STATS_FILE ".\n",
+    "\n",
+    "<b>Memory\n",
+    "\tMemory allocated by the plugin itself is shown below this text\n",
+    "\t(current and peak size, allocations during the last second and the\n",
+    "\tmost of them in one second); it should stay flat while GKrellM runs.\n",
     "\n",
     "Configured timezones are stored in ~/.gkrellm2/data/gkrellm-tz file.\n"
 };
@@ -87,6 +156,15 @@ static GtkTreeSelection *sel_row;
 static GtkTreeIter sel_row_iter;
 static GtkListStore *list_store;
 static GtkTreeModel *treemodel;
+static GtkTreeModel *filter;
+static GtkWidget *entry_search;
+static gchar *search;
+static GtkWidget *travel_scale;
+static GtkWidget *travel_entry;
+static GtkWidget *stats_label;
+static GtkWidget *stats_status;
+static guint stats_timer;
+static GtkWidget *mem_label;
 
 static void tz_reset_entries(void);
 static void tz_config_toggled(GtkCellRendererToggle *cell_renderer,
@@ -98,12 +176,34 @@ static void tz_config_set(GtkWidget *widget, gpointer data);
 static void tz_config_delete(GtkWidget *widget, gpointer data);
 static void tz_config_up(GtkWidget *widget, gpointer data);
 static void tz_config_down(GtkWidget *widget, gpointer data);
+static gboolean tz_config_visible(GtkTreeModel *model,
+                                  GtkTreeIter *iter,
+                                  gpointer data);
+static void tz_config_search(GtkEditable *editable, gpointer data);
 
 /* options callbacks */
 static void tz_config_op_12h(GtkToggleButton *toggle, gpointer data);
 static void tz_config_op_seconds(GtkToggleButton *toggle, gpointer data);
 static void tz_config_op_custom(GtkToggleButton *toggle, gpointer data);
+static void tz_config_op_glyphs(GtkToggleButton *toggle, gpointer data);
+static void tz_config_op_subsecond(GtkSpinButton *spin, gpointer data);
+static void tz_config_op_publish(GtkToggleButton *toggle, gpointer data);
+static void tz_config_op_page(GtkSpinButton *spin, gpointer data);
+static void tz_config_op_rotate(GtkSpinButton *spin, gpointer data);
+static void tz_config_op_threads(GtkSpinButton *spin, gpointer data);
 static void tz_config_op_left(GtkToggleButton *toggle, gpointer data);
+
+/* time travel callbacks */
+static gchar *tz_config_travel_format(GtkScale *scale,
+                                      gdouble value,
+                                      gpointer data);
+static void tz_config_travel_scrub(GtkRange *range, gpointer data);
+static void tz_config_travel_pin(GtkWidget *widget, gpointer data);
+static void tz_config_travel_now(GtkWidget *widget, gpointer data);
+static gboolean tz_config_stats_show(gpointer data);
+static void tz_config_stats_stop(GtkWidget *widget, gpointer data);
+static void tz_config_stats_reset(GtkWidget *widget, gpointer data);
+static void tz_config_stats_export(GtkWidget *widget, gpointer data);
 static void tz_config_op_center(GtkToggleButton *toggle, gpointer data);
 static void tz_config_op_right(GtkToggleButton *toggle, gpointer data);
 
@@ -113,56 +213,32 @@ tz_config_apply(struct tz_plugin *plugin)
 {
     GtkTreeIter iter;
     gboolean enabled;
+    gboolean valid;
+    gboolean added;
     gchar *entry[2];
-    struct tz_list_item *item;
-
-    if (gtk_tree_model_get_iter_first(treemodel, &iter) == FALSE)
-        return;
-
-    do {
-        gtk_tree_model_get(treemodel, &iter,
-                           0, &enabled,
-                           1, &entry[0],
-                           2, &entry[1], -1);
-        tz_list_add(plugin, enabled, entry[0], entry[1]);
-    } while (gtk_tree_model_iter_next(treemodel, &iter) == TRUE);
-
-    gtk_list_store_clear(list_store);
-    for (item = plugin->first; item != NULL; item = item->next) {
-        if (item->tz.enabled)
-            enabled = TRUE;
-        else
-            enabled = FALSE;
-        entry[0] = item->tz.label;
-        entry[1] = item->tz.timezone;
-        gtk_list_store_append(list_store, &iter);
-        gtk_list_store_set(list_store, &iter,
-                           0, enabled,
-                           1, entry[0],
-                           2, entry[1], -1);
-    }
 
-    if (plugin->options.format_short != NULL) {
-        free(plugin->options.format_short);
-        plugin->options.format_short = NULL;
-    }
-    if (plugin->options.format_long != NULL) {
-        free(plugin->options.format_long);
-        plugin->options.format_long = NULL;
-    }
-
-    plugin->options.twelve_hour = options.twelve_hour;
-    plugin->options.seconds = options.seconds;
-    plugin->options.custom = options.custom;
-
-    if (options.custom) {
-        plugin->options.format_short =
-            strdup(gtk_entry_get_text(GTK_ENTRY(entry_short)));
-        plugin->options.format_long =
-            strdup(gtk_entry_get_text(GTK_ENTRY(entry_long)));
+    /* rows rejected by tz_list_add (e.g. duplicate labels) are removed
+     * so that the model matches the list without being rebuilt */
+    if (gtk_tree_model_get_iter_first(treemodel, &iter)) {
+        do {
+            gtk_tree_model_get(treemodel, &iter,
+                               0, &enabled,
+                               1, &entry[0],
+                               2, &entry[1], -1);
+            added = tz_list_add(plugin, enabled, entry[0], entry[1]) == 0;
+            g_free(entry[0]);
+            g_free(entry[1]);
+
+            if (added)
+                valid = gtk_tree_model_iter_next(treemodel, &iter);
+            else
+                valid = gtk_list_store_remove(list_store, &iter);
+        } while (valid);
     }
 
-    plugin->options.align = options.align;
+    tz_options_apply(&plugin->options, &options,
+                     gtk_entry_get_text(GTK_ENTRY(entry_short)),
+                     gtk_entry_get_text(GTK_ENTRY(entry_long)));
 }
 
 
@@ -177,7 +253,20 @@ tz_config_tz_list(GtkWidget *vbox, struct tz_plugin *plugin)
     GtkTreeSelection *select;
     gboolean enabled;
     gchar *buf[2];
-    struct tz_list_item *item;
+    struct tz_entry *entry;
+    GtkWidget *hbox;
+    GtkWidget *label;
+
+    hbox = gtk_hbox_new(FALSE, 5);
+    gtk_box_pack_start(GTK_BOX(vbox), hbox, FALSE, FALSE, 0);
+
+    label = gtk_label_new("Search");
+    gtk_box_pack_start(GTK_BOX(hbox), label, FALSE, FALSE, 0);
+
+    entry_search = gtk_entry_new();
+    g_signal_connect(G_OBJECT(entry_search), "changed",
+                     G_CALLBACK(tz_config_search), NULL);
+    gtk_box_pack_start(GTK_BOX(hbox), entry_search, TRUE, TRUE, 0);
 
     scrolled = gtk_scrolled_window_new(NULL, NULL);
     gtk_scrolled_window_set_policy(GTK_SCROLLED_WINDOW(scrolled),
@@ -185,13 +274,13 @@ tz_config_tz_list(GtkWidget *vbox, struct tz_plugin *plugin)
     gtk_box_pack_start(GTK_BOX(vbox), scrolled, TRUE, TRUE, 0);
 
     list_store = gtk_list_store_new(3, G_TYPE_BOOLEAN, G_TYPE_STRING, G_TYPE_STRING);
-    for (item = plugin->first; item != NULL; item = item->next) {
-        if (item->tz.enabled)
+    for (entry = plugin->list.first; entry != NULL; entry = entry->next) {
+        if (entry->tz.enabled)
             enabled = TRUE;
         else
             enabled = FALSE;
-        buf[0] = item->tz.label;
-        buf[1] = item->tz.timezone;
+        buf[0] = (gchar *) entry->tz.label;
+        buf[1] = (gchar *) entry->tz.timezone;
         gtk_list_store_append(list_store, &iter);
         gtk_list_store_set(list_store, &iter,
                            0, enabled,
@@ -200,11 +289,21 @@ tz_config_tz_list(GtkWidget *vbox, struct tz_plugin *plugin)
     }
 
     treemodel = GTK_TREE_MODEL(list_store);
-    tree = gtk_tree_view_new_with_model(treemodel);
+    filter = gtk_tree_model_filter_new(treemodel, NULL);
+    gtk_tree_model_filter_set_visible_func(GTK_TREE_MODEL_FILTER(filter),
+                                           tz_config_visible, NULL, NULL);
+    g_free(search);
+    search = NULL;
+
+    tree = gtk_tree_view_new_with_model(filter);
+    g_object_unref(G_OBJECT(filter));
 
+    /* fixed sizes let the view skip measuring every row */
     renderer = gtk_cell_renderer_toggle_new();
     column = gtk_tree_view_column_new_with_attributes(list_titles[0],
                     renderer, "active", 0, NULL);
+    gtk_tree_view_column_set_sizing(column, GTK_TREE_VIEW_COLUMN_FIXED);
+    gtk_tree_view_column_set_fixed_width(column, 30);
     gtk_tree_view_append_column(GTK_TREE_VIEW(tree), column);
     g_signal_connect(G_OBJECT(renderer), "toggled",
                      G_CALLBACK(tz_config_toggled), NULL);
@@ -212,13 +311,21 @@ tz_config_tz_list(GtkWidget *vbox, struct tz_plugin *plugin)
     renderer = gtk_cell_renderer_text_new();
     column = gtk_tree_view_column_new_with_attributes(list_titles[1],
                     renderer, "text", 1, NULL);
+    gtk_tree_view_column_set_sizing(column, GTK_TREE_VIEW_COLUMN_FIXED);
+    gtk_tree_view_column_set_fixed_width(column, 150);
+    gtk_tree_view_column_set_resizable(column, TRUE);
     gtk_tree_view_append_column(GTK_TREE_VIEW(tree), column);
 
     renderer = gtk_cell_renderer_text_new();
     column = gtk_tree_view_column_new_with_attributes(list_titles[2],
                     renderer, "text", 2, NULL);
+    gtk_tree_view_column_set_sizing(column, GTK_TREE_VIEW_COLUMN_FIXED);
+    gtk_tree_view_column_set_fixed_width(column, 150);
+    gtk_tree_view_column_set_resizable(column, TRUE);
     gtk_tree_view_append_column(GTK_TREE_VIEW(tree), column);
 
+    gtk_tree_view_set_fixed_height_mode(GTK_TREE_VIEW(tree), TRUE);
+
     select = gtk_tree_view_get_selection(GTK_TREE_VIEW(tree));
     gtk_tree_selection_set_mode(select, GTK_SELECTION_SINGLE);
     g_signal_connect(G_OBJECT(select), "changed",
@@ -403,6 +510,161 @@ tz_config_options(GtkWidget *vbox, struct tz_plugin *plugin)
     g_signal_connect(G_OBJECT(button), "toggled",
                      G_CALLBACK(tz_config_op_right), NULL);
     gtk_container_add(GTK_CONTAINER(hbox), button);
+
+    /* Rendering */
+    button = gtk_check_button_new_with_label(
+                    "Draw time from pre-rendered glyphs");
+    gtk_toggle_button_set_active(GTK_TOGGLE_BUTTON(button),
+                                 options.glyph_cache);
+    g_signal_connect(G_OBJECT(button), "toggled",
+                     G_CALLBACK(tz_config_op_glyphs), NULL);
+    gtk_box_pack_start(GTK_BOX(vbox), button, FALSE, FALSE, 0);
+
+    /* Fractional seconds */
+    hbox = gtk_hbox_new(FALSE, 5);
+    gtk_box_pack_start(GTK_BOX(vbox), hbox, FALSE, FALSE, 0);
+
+    label = gtk_label_new("Redraw fractional seconds (per second):");
+    gtk_misc_set_alignment(GTK_MISC(label), 0.0, 0.5);
+    gtk_box_pack_start(GTK_BOX(hbox), label, FALSE, FALSE, 0);
+
+    button = gtk_spin_button_new_with_range(0, TZ_SUBSECOND_MAX,
+                                            TZ_SUBSECOND_MIN);
+    gtk_spin_button_set_value(GTK_SPIN_BUTTON(button), options.subsecond_hz);
+    g_signal_connect(G_OBJECT(button), "value-changed",
+                     G_CALLBACK(tz_config_op_subsecond), NULL);
+    gtk_box_pack_start(GTK_BOX(hbox), button, FALSE, FALSE, 0);
+
+    /* Shared memory */
+    button = gtk_check_button_new_with_label(
+                    "Publish current times in shared memory");
+    gtk_toggle_button_set_active(GTK_TOGGLE_BUTTON(button),
+                                 options.publish);
+    g_signal_connect(G_OBJECT(button), "toggled",
+                     G_CALLBACK(tz_config_op_publish), NULL);
+    gtk_box_pack_start(GTK_BOX(vbox), button, FALSE, FALSE, 0);
+
+    /* Paging */
+    hbox = gtk_hbox_new(FALSE, 5);
+    gtk_box_pack_start(GTK_BOX(vbox), hbox, FALSE, FALSE, 0);
+
+    label = gtk_label_new("Timezones per page (0 shows all):");
+    gtk_misc_set_alignment(GTK_MISC(label), 0.0, 0.5);
+    gtk_box_pack_start(GTK_BOX(hbox), label, FALSE, FALSE, 0);
+
+    button = gtk_spin_button_new_with_range(0, TZ_PAGE_MAX, 1);
+    gtk_spin_button_set_value(GTK_SPIN_BUTTON(button), options.page_size);
+    g_signal_connect(G_OBJECT(button), "value-changed",
+                     G_CALLBACK(tz_config_op_page), NULL);
+    gtk_box_pack_start(GTK_BOX(hbox), button, FALSE, FALSE, 0);
+
+    hbox = gtk_hbox_new(FALSE, 5);
+    gtk_box_pack_start(GTK_BOX(vbox), hbox, FALSE, FALSE, 0);
+
+    label = gtk_label_new("Switch to the next page every (seconds):");
+    gtk_misc_set_alignment(GTK_MISC(label), 0.0, 0.5);
+    gtk_box_pack_start(GTK_BOX(hbox), label, FALSE, FALSE, 0);
+
+    button = gtk_spin_button_new_with_range(0, TZ_ROTATE_MAX, 1);
+    gtk_spin_button_set_value(GTK_SPIN_BUTTON(button), options.page_rotate);
+    g_signal_connect(G_OBJECT(button), "value-changed",
+                     G_CALLBACK(tz_config_op_rotate), NULL);
+    gtk_box_pack_start(GTK_BOX(hbox), button, FALSE, FALSE, 0);
+
+    /* Threads */
+    hbox = gtk_hbox_new(FALSE, 5);
+    gtk_box_pack_start(GTK_BOX(vbox), hbox, FALSE, FALSE, 0);
+
+    label = gtk_label_new("Threads converting long lists of timezones:");
+    gtk_misc_set_alignment(GTK_MISC(label), 0.0, 0.5);
+    gtk_box_pack_start(GTK_BOX(hbox), label, FALSE, FALSE, 0);
+
+    button = gtk_spin_button_new_with_range(1, TZ_THREADS_MAX, 1);
+    gtk_spin_button_set_value(GTK_SPIN_BUTTON(button), options.threads);
+    g_signal_connect(G_OBJECT(button), "value-changed",
+                     G_CALLBACK(tz_config_op_threads), NULL);
+    gtk_box_pack_start(GTK_BOX(hbox), button, FALSE, FALSE, 0);
+}
+
+
+static void
+tz_config_travel(GtkWidget *vbox, struct tz_plugin *plugin)
+{
+    GtkWidget *label;
+    GtkWidget *hbox;
+    GtkWidget *button;
+
+    label = gtk_label_new("Shift shown time by:");
+    gtk_misc_set_alignment(GTK_MISC(label), 0.0, 0.5);
+    gtk_box_pack_start(GTK_BOX(vbox), label, FALSE, FALSE, 0);
+
+    travel_scale = gtk_hscale_new_with_range(-TRAVEL_RANGE, TRAVEL_RANGE,
+                                             TRAVEL_STEP);
+    gtk_range_set_value(GTK_RANGE(travel_scale),
+                        plugin->travel.offset / 60);
+    g_signal_connect(G_OBJECT(travel_scale), "format-value",
+                     G_CALLBACK(tz_config_travel_format), NULL);
+    g_signal_connect(G_OBJECT(travel_scale), "value-changed",
+                     G_CALLBACK(tz_config_travel_scrub), plugin);
+    gtk_box_pack_start(GTK_BOX(vbox), travel_scale, FALSE, FALSE, 5);
+
+    hbox = gtk_hbox_new(FALSE, 5);
+    gtk_box_pack_start(GTK_BOX(vbox), hbox, FALSE, FALSE, 0);
+
+    label = gtk_label_new("Pin to");
+    gtk_box_pack_start(GTK_BOX(hbox), label, FALSE, FALSE, 0);
+
+    travel_entry = gtk_entry_new_with_max_length(32);
+    gtk_box_pack_start(GTK_BOX(hbox), travel_entry, TRUE, TRUE, 0);
+
+    button = gtk_button_new_with_label("Pin");
+    g_signal_connect(G_OBJECT(button), "clicked",
+                     G_CALLBACK(tz_config_travel_pin), plugin);
+    gtk_box_pack_start(GTK_BOX(hbox), button, FALSE, FALSE, 0);
+
+    button = gtk_button_new_with_label("Now");
+    g_signal_connect(G_OBJECT(button), "clicked",
+                     G_CALLBACK(tz_config_travel_now), plugin);
+    gtk_box_pack_start(GTK_BOX(hbox), button, FALSE, FALSE, 0);
+}
+
+
+static void
+tz_config_stats(GtkWidget *vbox, struct tz_plugin *plugin)
+{
+    GtkWidget *label;
+    GtkWidget *hbox;
+    GtkWidget *button;
+
+    label = gtk_label_new("Time from a second boundary to:");
+    gtk_misc_set_alignment(GTK_MISC(label), 0.0, 0.5);
+    gtk_box_pack_start(GTK_BOX(vbox), label, FALSE, FALSE, 0);
+
+    stats_label = gtk_label_new(NULL);
+    gtk_misc_set_alignment(GTK_MISC(stats_label), 0.0, 0.5);
+    gtk_box_pack_start(GTK_BOX(vbox), stats_label, FALSE, FALSE, 5);
+
+    hbox = gtk_hbox_new(FALSE, 5);
+    gtk_box_pack_start(GTK_BOX(vbox), hbox, FALSE, FALSE, 0);
+
+    button = gtk_button_new_with_label("Reset");
+    g_signal_connect(G_OBJECT(button), "clicked",
+                     G_CALLBACK(tz_config_stats_reset), plugin);
+    gtk_box_pack_start(GTK_BOX(hbox), button, FALSE, FALSE, 0);
+
+    button = gtk_button_new_with_label("Export");
+    g_signal_connect(G_OBJECT(button), "clicked",
+                     G_CALLBACK(tz_config_stats_export), plugin);
+    gtk_box_pack_start(GTK_BOX(hbox), button, FALSE, FALSE, 0);
+
+    stats_status = gtk_label_new(NULL);
+    gtk_box_pack_start(GTK_BOX(hbox), stats_status, FALSE, FALSE, 0);
+
+    /* refresh the numbers while the config window is open */
+    tz_config_stats_show(plugin);
+    stats_timer = g_timeout_add(1000, tz_config_stats_show, plugin);
+    g_signal_connect(G_OBJECT(stats_label), "destroy",
+                     G_CALLBACK(tz_config_stats_stop), NULL);
 }
 
 
@@ -427,6 +689,14 @@ tz_config_create_tabs(GtkWidget *tab_vbox, struct tz_plugin *plugin)
     vbox = gkrellm_gtk_framed_notebook_page(tabs, "Options");
     tz_config_options(vbox, plugin);
 
+    /* Time travel */
+    vbox = gkrellm_gtk_framed_notebook_page(tabs, "Time travel");
+    tz_config_travel(vbox, plugin);
+
+    /* Latency */
+    vbox = gkrellm_gtk_framed_notebook_page(tabs, "Latency");
+    tz_config_stats(vbox, plugin);
+
     /* Info tab */
     vbox = gkrellm_gtk_framed_notebook_page(tabs, "Info");
     text = gkrellm_gtk_scrolled_text_view(vbox, NULL, GTK_POLICY_AUTOMATIC,
@@ -434,6 +704,14 @@ tz_config_create_tabs(GtkWidget *tab_vbox, struct tz_plugin *plugin)
     for (i = 0; i < sizeof(info_text) / sizeof(gchar *); i++)
         gkrellm_gtk_text_view_append(text, info_text[i]);
 
+    /* refreshed together with latency (see tz_config_stats_show) */
+    mem_label = gtk_label_new(NULL);
+    gtk_misc_set_alignment(GTK_MISC(mem_label), 0.0, 0.5);
+    gtk_box_pack_start(GTK_BOX(vbox), mem_label, FALSE, FALSE, 5);
+    g_signal_connect(G_OBJECT(mem_label), "destroy",
+                     G_CALLBACK(gtk_widget_destroyed), &mem_label);
+    tz_config_stats_show(plugin);
+
     /* About tab */
     label = gtk_label_new("About");
     gtk_notebook_append_page(GTK_NOTEBOOK(tabs),
@@ -455,9 +733,13 @@ tz_config_toggled(GtkCellRendererToggle *cell_renderer,
                   gpointer user_data)
 {
     gboolean enabled;
+    GtkTreeIter filter_iter;
     GtkTreeIter iter;
 
-    gtk_tree_model_get_iter_from_string(treemodel, &iter, path);
+    if (!gtk_tree_model_get_iter_from_string(filter, &filter_iter, path))
+        return;
+    gtk_tree_model_filter_convert_iter_to_child_iter(
+                GTK_TREE_MODEL_FILTER(filter), &iter, &filter_iter);
     gtk_tree_model_get(treemodel, &iter, 0, &enabled, -1);
     gtk_list_store_set(list_store, &iter, 0, !enabled, -1);
 }
@@ -477,7 +759,8 @@ tz_config_selected(GtkTreeSelection *selection, gpointer data)
         g_free(entry[0]);
         g_free(entry[1]);
 
-        sel_row_iter = iter;
+        gtk_tree_model_filter_convert_iter_to_child_iter(
+                    GTK_TREE_MODEL_FILTER(filter), &sel_row_iter, &iter);
         sel_row = selection;
     } else {
         tz_reset_entries();
@@ -546,25 +829,55 @@ cleanup:
 }
 
 
+/** Find a row next to the selected one among visible rows.
+ *
+ * @param up
+ *      nonzero for the row above the selected one, zero for the row below.
+ *
+ * @param iter
+ *      where to store list_store iterator of the row.
+ *
+ * @return
+ *      TRUE if the row exists.
+ */
+static gboolean
+tz_config_neighbour(int up, GtkTreeIter *iter)
+{
+    GtkTreeIter filter_iter;
+    GtkTreeIter neighbour;
+    GtkTreePath *path;
+    gboolean found;
+
+    if (!GTK_IS_TREE_SELECTION(sel_row)
+        || !gtk_tree_selection_get_selected(sel_row, NULL, &filter_iter))
+        return FALSE;
+
+    path = gtk_tree_model_get_path(filter, &filter_iter);
+    if (up) {
+        found = gtk_tree_path_prev(path);
+    } else {
+        gtk_tree_path_next(path);
+        found = TRUE;
+    }
+    found = found && gtk_tree_model_get_iter(filter, &neighbour, path);
+    gtk_tree_path_free(path);
+
+    if (found) {
+        gtk_tree_model_filter_convert_iter_to_child_iter(
+                    GTK_TREE_MODEL_FILTER(filter), iter, &neighbour);
+    }
+
+    return found;
+}
+
+
 static void
 tz_config_up(GtkWidget *widget, gpointer data)
 {
     GtkTreeIter iter;
-    GtkTreeIter iter2;
-
-    if (GTK_IS_TREE_SELECTION(sel_row)
-        && gtk_tree_selection_iter_is_selected(sel_row, &sel_row_iter)) {
-        gtk_tree_model_get_iter_first(treemodel, &iter);
-
-        if (!gtk_tree_selection_iter_is_selected(sel_row, &iter)) {
-            while (!gtk_tree_selection_iter_is_selected(sel_row, &iter)) {
-                iter2 = iter;
-                gtk_tree_model_iter_next(treemodel, &iter);
-            }
-            iter = iter2;
-            gtk_list_store_swap(list_store, &iter, &sel_row_iter);
-        }
-    }
+
+    if (tz_config_neighbour(1, &iter))
+        gtk_list_store_move_before(list_store, &sel_row_iter, &iter);
 }
 
 
@@ -573,12 +886,47 @@ tz_config_down(GtkWidget *widget, gpointer data)
 {
     GtkTreeIter iter;
 
-    if (GTK_IS_TREE_SELECTION(sel_row)
-        && gtk_tree_selection_iter_is_selected(sel_row, &sel_row_iter)) {
-        iter = sel_row_iter;
-        if (gtk_tree_model_iter_next(treemodel, &iter))
-            gtk_list_store_swap(list_store, &iter, &sel_row_iter);
+    if (tz_config_neighbour(0, &iter))
+        gtk_list_store_move_after(list_store, &sel_row_iter, &iter);
+}
+
+
+/** Check whether a row matches the search string. */
+static gboolean
+tz_config_visible(GtkTreeModel *model, GtkTreeIter *iter, gpointer data)
+{
+    gchar *entry[2];
+    gchar *folded;
+    gboolean visible = FALSE;
+    int i;
+
+    if (search == NULL)
+        return TRUE;
+
+    gtk_tree_model_get(model, iter, 1, &entry[0], 2, &entry[1], -1);
+    for (i = 0; i < 2 && !visible; i++) {
+        if (entry[i] == NULL)
+            continue;
+        folded = g_utf8_casefold(entry[i], -1);
+        visible = strstr(folded, search) != NULL;
+        g_free(folded);
     }
+    g_free(entry[0]);
+    g_free(entry[1]);
+
+    return visible;
+}
+
+
+static void
+tz_config_search(GtkEditable *editable, gpointer data)
+{
+    const gchar *text = gtk_entry_get_text(GTK_ENTRY(entry_search));
+
+    g_free(search);
+    search = (*text != '\0') ? g_utf8_casefold(text, -1) : NULL;
+
+    gtk_tree_model_filter_refilter(GTK_TREE_MODEL_FILTER(filter));
 }
 
 
@@ -618,6 +966,48 @@ tz_config_op_custom(GtkToggleButton *toggle, gpointer data)
 }
 
 
+static void
+tz_config_op_glyphs(GtkToggleButton *toggle, gpointer data)
+{
+    options.glyph_cache = gtk_toggle_button_get_active(toggle);
+}
+
+
+static void
+tz_config_op_subsecond(GtkSpinButton *spin, gpointer data)
+{
+    options.subsecond_hz = gtk_spin_button_get_value_as_int(spin);
+}
+
+
+static void
+tz_config_op_publish(GtkToggleButton *toggle, gpointer data)
+{
+    options.publish = gtk_toggle_button_get_active(toggle);
+}
+
+
+static void
+tz_config_op_page(GtkSpinButton *spin, gpointer data)
+{
+    options.page_size = gtk_spin_button_get_value_as_int(spin);
+}
+
+
+static void
+tz_config_op_rotate(GtkSpinButton *spin, gpointer data)
+{
+    options.page_rotate = gtk_spin_button_get_value_as_int(spin);
+}
+
+
+static void
+tz_config_op_threads(GtkSpinButton *spin, gpointer data)
+{
+    options.threads = gtk_spin_button_get_value_as_int(spin);
+}
+
+
 static void
 tz_config_op_left(GtkToggleButton *toggle, gpointer data)
 {
@@ -640,3 +1030,151 @@ tz_config_op_right(GtkToggleButton *toggle, gpointer data)
     if (gtk_toggle_button_get_active(toggle))
         options.align = TA_RIGHT;
 }
+
+
+static gchar *
+tz_config_travel_format(GtkScale *scale, gdouble value, gpointer data)
+{
+    long minutes = (long) value;
+    long abs = (minutes < 0) ? -minutes : minutes;
+
+    return g_strdup_printf("%c%ldd %02ld:%02ld",
+                           (minutes < 0) ? '-' : '+',
+                           abs / (24 * 60), abs / 60 % 24, abs % 60);
+}
+
+
+static void
+tz_config_travel_scrub(GtkRange *range, gpointer data)
+{
+    struct tz_plugin *plugin = data;
+
+    tz_list_travel(plugin, plugin->travel.pinned, plugin->travel.instant,
+                   60 * (long) gtk_range_get_value(range));
+}
+
+
+static void
+tz_config_travel_pin(GtkWidget *widget, gpointer data)
+{
+    struct tz_plugin *plugin = data;
+    struct tm tm;
+    time_t t;
+
+    memset(&tm, '\0', sizeof(tm));
+    if (sscanf(gtk_entry_get_text(GTK_ENTRY(travel_entry)),
+               "%d-%d-%d %d:%d",
+               &tm.tm_year, &tm.tm_mon, &tm.tm_mday,
+               &tm.tm_hour, &tm.tm_min) < 3)
+        return;
+
+    tm.tm_year -= 1900;
+    tm.tm_mon--;
+    tm.tm_isdst = -1;
+    if ((t = mktime(&tm)) == (time_t) -1)
+        return;
+
+    tz_list_travel(plugin, 1, t, plugin->travel.offset);
+}
+
+
+static void
+tz_config_travel_now(GtkWidget *widget, gpointer data)
+{
+    struct tz_plugin *plugin = data;
+
+    gtk_entry_set_text(GTK_ENTRY(travel_entry), "");
+    plugin->travel.offset = 0;
+    gtk_range_set_value(GTK_RANGE(travel_scale), 0);
+    tz_list_travel(plugin, 0, 0, 0);
+}
+
+
+static gboolean
+tz_config_stats_show(gpointer data)
+{
+    struct tz_stats *stats = &((struct tz_plugin *) data)->stats;
+    const struct tz_hist *hist[] = { &stats->skew, &stats->paint };
+    struct tz_mem mem;
+    gchar text[1024];
+    int len;
+    int i;
+
+    len = g_snprintf(text, sizeof(text),
+                     "<tt>           p50 [ms]  p99 [ms]  max [ms]  "
+                     "seconds\n");
+    for (i = 0; i < 2 && len < sizeof(text); i++) {
+        len += g_snprintf(text + len, sizeof(text) - len,
+                          "%-9s %9.3f %9.3f %9.3f  %lu\n",
+                          (i == 0) ? "update" : "paint",
+                          tz_hist_percentile(hist[i], 50) / 1000.0,
+                          tz_hist_percentile(hist[i], 99) / 1000.0,
+                          hist[i]->max / 1000.0,
+                          hist[i]->count);
+    }
+
+    if (len < sizeof(text))
+        g_strlcpy(text + len, "</tt>", sizeof(text) - len);
+
+    gtk_label_set_markup(GTK_LABEL(stats_label), text);
+
+    if (mem_label != NULL) {
+        tz_mem_get(&mem);
+        g_snprintf(text, sizeof(text),
+                   "<tt>memory    %lu bytes in %lu blocks, peak %lu\n"
+                   "allocs    %lu last second, %lu max, %lu total</tt>",
+                   (unsigned long) mem.live, mem.blocks,
+                   (unsigned long) mem.peak,
+                   mem.tick, mem.tick_max, mem.allocs);
+        gtk_label_set_markup(GTK_LABEL(mem_label), text);
+    }
+
+    return TRUE;
+}
+
+
+static void
+tz_config_stats_stop(GtkWidget *widget, gpointer data)
+{
+    if (stats_timer != 0) {
+        g_source_remove(stats_timer);
+        stats_timer = 0;
+    }
+}
+
+
+static void
+tz_config_stats_reset(GtkWidget *widget, gpointer data)
+{
+    struct tz_plugin *plugin = data;
+
+    tz_stats_reset(&plugin->stats);
+    gtk_label_set_text(GTK_LABEL(stats_status), "");
+    tz_config_stats_show(plugin);
+}
+
+
+static void
+tz_config_stats_export(GtkWidget *widget, gpointer data)
+{
+    struct tz_plugin *plugin = data;
+    gchar *filename;
+    FILE *file;
+    int ret = -1;
+
+    filename = g_build_path(G_DIR_SEPARATOR_S,
+                            gkrellm_homedir(),
+                            GKRELLM_DATA_DIR,
+                            STATS_FILE,
+                            NULL);
+
+    if ((file = fopen(filename, "w")) != NULL) {
+        ret = tz_stats_write(&plugin->stats, file);
+        if (fclose(file) != 0)
+            ret = -1;
+    }
+
+    gtk_label_set_text(GTK_LABEL(stats_status),
+                       (ret == 0) ? "Exported" : "Cannot write " STATS_FILE);
+    g_free(filename);
+}
@@ -0,0 +1,856 @@
+/*
+ * Convert timestamps to configured timezones.
+ * Copyright (C) 2026 Jiri Denemark
+ *
+ * This file is part of gkrellm-tz.
+ *
+ * gkrellm-tz is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/** @file
+ * Convert timestamps to configured timezones.
+ * Reads seconds since epoch (optionally with a fractional part) from
+ * standard input, one per line, and prints each of them converted to all
+ * enabled timezones configured for gkrellm-tz.
+ * Alternatively, a range of time may be replayed on a simulated clock the
+ * way the plugin shows it, printing only changes or checking all strings
+ * against the C library and measuring the cost of each tick. Self-checks
+ * and benchmarks of the engine (see bench.h) may be run as well.
+ * @author Jiri Denemark
+ */
+
+#include <locale.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+
+#include "arena.h"
+#include "options.h"
+#include "item.h"
+#include "civil.h"
+#include "store.h"
+#include "entry.h"
+#include "clock.h"
+#include "mem.h"
+#include "shm.h"
+#include "bench.h"
+
+#define CONFIG_KEYWORD  "gkrellm-tz"
+#define DATA_FILE       ".gkrellm2/data/gkrellm-tz"
+#define CONFIG_FILE     ".gkrellm2/user-config"
+#define LINE            1024
+
+
+/** Timezones to convert to. */
+struct convert_list {
+    /** Include disabled timezones. */
+    int all;
+    /** Number of timezones. */
+    int count;
+    /** Size of the arrays. */
+    int size;
+    /** Timezones. */
+    struct tz_item *items;
+    /** Offsets from UTC of all timezones. */
+    long *gmtoff;
+    /** Broken-down time of all timezones. */
+    struct tm *tm;
+    /** Renderer of time strings (see tz_format_renderer). */
+    enum tz_render render;
+    /** Memory for labels and timezone names. */
+    struct tz_arena arena;
+};
+
+
+/** Cost of simulated ticks. */
+struct convert_cost {
+    /** Number of ticks. */
+    long ticks;
+    /** Number of formatted time strings. */
+    long formatted;
+    /** Total time spent in all ticks (ns). */
+    long long total;
+    /** The most expensive tick (ns). */
+    long max;
+    /** Number of ticks at which local time type of some zone changed. */
+    long edges;
+    /** Total time spent in such ticks (ns). */
+    long long edge_total;
+    /** The most expensive of such ticks (ns). */
+    long edge_max;
+};
+
+
+/** Results of checking time strings against the C library. */
+struct convert_check {
+    /** Format prepared by tz_format_prepare. */
+    const char *format;
+    /** Number of checked strings. */
+    long checked;
+    /** Number of strings different from the C library. */
+    long mismatches;
+};
+
+
+/** Called for every simulated tick after all time strings are up to date.
+ *
+ * @param opaque
+ *      data passed to simulate.
+ *
+ * @param list
+ *      simulated timezones.
+ *
+ * @param t
+ *      simulated time.
+ *
+ * @param changed
+ *      nonzero if some time string changed.
+ */
+typedef void (*convert_tick)(void *opaque,
+                             struct convert_list *list,
+                             time_t t,
+                             int changed);
+
+
+static void
+usage(const char *prog)
+{
+    fprintf(stderr,
+            "Usage: %s [-ahlBC] [-c CONFIG] [-f ZONES] [-s SEPARATOR]\n"
+            "          [-S FROM:UNTIL[:STEP]] [-M CYCLES] [-K YEARS]\n"
+            "          [-T THREADS]\n"
+            "\n"
+            "Reads seconds since epoch (e.g., 1396771200 or 1396771200.25)\n"
+            "from standard input, one per line, and prints each of them\n"
+            "converted to all timezones configured in gkrellm-tz.\n"
+            "\n"
+            "  -a            include disabled timezones\n"
+            "  -c CONFIG     GKrellM config file (~/" CONFIG_FILE ")\n"
+            "  -f ZONES      timezones file (~/" DATA_FILE ")\n"
+            "  -h            print a header with timezone labels\n"
+            "  -l            use long (tooltip) time format\n"
+            "  -s SEPARATOR  column separator (tab)\n"
+            "  -S FROM:UNTIL[:STEP]\n"
+            "                instead of reading standard input, replay ticks\n"
+            "                from FROM to UNTIL (seconds since epoch) every\n"
+            "                STEP seconds (1) on a simulated clock and print\n"
+            "                only ticks at which some time string changes\n"
+            "  -C            with -S, check all strings against the C library\n"
+            "                and print cost of ticks instead of the strings\n"
+            "  -M CYCLES     reload configuration and timezones CYCLES times\n"
+            "                and check no memory is leaked\n"
+            "  -K YEARS      check the engine against the C library within\n"
+            "                YEARS years around 1970 and exit\n"
+            "  -B            print cost (ns) of the engine's building blocks\n"
+            "                and the C library routines they replace and exit\n"
+            "  -T THREADS    check time strings converted by THREADS threads\n"
+            "                in parallel match those converted by one and exit\n",
+            prog);
+}
+
+
+static char *
+home_file(const char *name)
+{
+    const char *home = getenv("HOME");
+    char *path;
+
+    if (home == NULL)
+        home = ".";
+
+    if ((path = tz_mem_alloc(strlen(home) + strlen(name) + 2)) != NULL)
+        sprintf(path, "%s/%s", home, name);
+
+    return path;
+}
+
+
+static int
+convert_add(void *opaque,
+            int enabled,
+            const char *label,
+            const char *timezone)
+{
+    struct convert_list *list = opaque;
+    struct tz_item *item;
+
+    if ((!enabled && !list->all) || *timezone == '\0')
+        return 0;
+
+    if (list->count == list->size) {
+        int size = (list->size > 0) ? 2 * list->size : 16;
+        void *p;
+
+        p = tz_mem_realloc(list->items, size * sizeof(*list->items));
+        if (p == NULL)
+            return -1;
+        list->items = p;
+        p = tz_mem_realloc(list->gmtoff, size * sizeof(*list->gmtoff));
+        if (p == NULL)
+            return -1;
+        list->gmtoff = p;
+        p = tz_mem_realloc(list->tm, size * sizeof(*list->tm));
+        if (p == NULL)
+            return -1;
+        list->tm = p;
+        list->size = size;
+    }
+
+    item = list->items + list->count;
+    tz_item_init(item);
+    item->enabled = enabled;
+    item->label = tz_arena_intern(&list->arena,
+                                  (*label != '\0') ? label : timezone);
+    item->timezone = tz_arena_intern(&list->arena, timezone);
+    item->fixed = tz_zone_fixed(&list->arena, timezone);
+    if (item->fixed == NULL)
+        item->tzfile = tz_tzfile_load(&list->arena, timezone);
+    if (item->fixed == NULL && item->tzfile == NULL)
+        item->rule = tz_rule_parse(&list->arena, timezone);
+    if (item->label == NULL || item->timezone == NULL)
+        return -1;
+
+    list->count++;
+    return 0;
+}
+
+
+static void
+load_options(struct tz_options *options, const char *filename)
+{
+    FILE *file;
+    char line[LINE];
+    size_t len = strlen(CONFIG_KEYWORD);
+    char *nl;
+
+    if ((file = fopen(filename, "r")) == NULL)
+        return;
+
+    while (fgets(line, LINE, file) != NULL) {
+        if (strncmp(line, CONFIG_KEYWORD, len) != 0 || line[len] != ' ')
+            continue;
+        if ((nl = strchr(line, '\n')) != NULL)
+            *nl = '\0';
+        tz_options_load(options, line + len + 1);
+    }
+
+    fclose(file);
+}
+
+
+/** Add a timezone read from the timezones file to a list.
+ * This is an adapter between tz_store_read and tz_entries_add.
+ */
+static int
+check_memory_add(void *opaque,
+                 int enabled,
+                 const char *label,
+                 const char *timezone)
+{
+    if (tz_entries_add(opaque, enabled, label, timezone) == NULL)
+        return -1;
+    return 0;
+}
+
+
+/** Load configuration and timezones repeatedly and go through the steps
+ * the plugin takes every time configuration is applied, using the same
+ * code the plugin does: the list is cleaned, timezones are added (loading
+ * timezone files and rules) and stored back, the edited options replace
+ * the current ones, rings are allocated for the batch and filled with
+ * strings for the current second, and the strings are published in a
+ * shared memory object. Memory allocated by the plugin's code must not
+ * grow. The first cycle only warms up the arena. Panels and pre-rendered
+ * glyphs need GTK+ and are not covered.
+ *
+ * @param edited
+ *      options as if they were edited in the config.
+ *
+ * @param config
+ *      GKrellM config file or NULL.
+ *
+ * @param zones
+ *      timezones file.
+ *
+ * @param cycles
+ *      number of cycles.
+ *
+ * @return
+ *      0 if no memory was leaked, 1 otherwise.
+ */
+static int
+check_memory(struct tz_options *edited,
+             const char *config,
+             const char *zones,
+             long cycles)
+{
+    struct tz_mem before;
+    struct tz_mem after;
+    struct tz_entries list;
+    struct tz_batch *batch = &list.batch;
+    struct tz_options options;
+    struct tz_shm *shm;
+    struct tz_shm_zone *published;
+    struct timespec now;
+    char format[TZ_FORMAT];
+    char name[32];
+    FILE *file;
+    long i;
+    int j;
+
+    snprintf(name, sizeof(name), "/gkrellm-tz-convert-%ld", (long) getpid());
+    tz_clock_real(&now);
+    tz_entries_init(&list, sizeof(struct tz_entry));
+    memset(&options, '\0', sizeof(options));
+
+    memset(&before, '\0', sizeof(before));
+    for (i = 0; i <= cycles; i++) {
+        if (i == 1)
+            tz_mem_get(&before);
+
+        if (config != NULL)
+            load_options(edited, config);
+
+        /* tz_list_clean */
+        tz_entries_clean(&list);
+
+        /* tz_config_apply */
+        if ((file = fopen(zones, "r")) == NULL) {
+            fprintf(stderr, "cannot open timezones file %s\n", zones);
+            tz_entries_free(&list);
+            return 1;
+        }
+        tz_store_read(file, check_memory_add, &list);
+        fclose(file);
+        tz_options_apply(&options, edited,
+                         edited->format_short, edited->format_long);
+
+        /* tz_list_store */
+        if ((file = tmpfile()) != NULL) {
+            tz_entries_store(&list, file);
+            fclose(file);
+        }
+
+        /* tz_list_update */
+        tz_batch_rings(batch);
+        tz_batch_zones(batch, now.tv_sec);
+        tz_format_prepare(tz_format_short(options), format, TZ_FORMAT);
+        tz_item_convert(batch->tz, batch->gmtoff, batch->tm, batch->count,
+                        now.tv_sec, now.tv_sec + 1, now.tv_nsec,
+                        tz_format_renderer(tz_format_short(options)),
+                        format, tz_format_period(format));
+
+        /* tz_list_publish */
+        if ((shm = tz_shm_open(name)) != NULL) {
+            published = tz_shm_begin(shm, batch->count);
+            if (published != NULL) {
+                for (j = 0; j < batch->count; j++) {
+                    snprintf(published[j].time_short, TZ_SHM_SHORT, "%s",
+                             batch->tz[j]->ring[tz_item_slot(now.tv_sec)]
+                                 .time_short);
+                }
+                tz_shm_commit(shm, batch->count, &now);
+            }
+            tz_shm_close(shm);
+        }
+    }
+    tz_mem_get(&after);
+    tz_entries_free(&list);
+    tz_mem_free(options.format_short);
+    tz_mem_free(options.format_long);
+
+    printf("cycles\t%ld\n", cycles);
+    printf("live bytes\t%lu\t%lu\n",
+           (unsigned long) before.live, (unsigned long) after.live);
+    printf("live blocks\t%lu\t%lu\n", before.blocks, after.blocks);
+    printf("peak bytes\t%lu\n", (unsigned long) after.peak);
+    printf("allocations\t%lu\n", after.allocs - before.allocs);
+
+    return (after.live > before.live || after.blocks > before.blocks);
+}
+
+
+/** Replay a range of time on a simulated clock.
+ * As in the plugin, zones are only looked up when they change and time
+ * strings are only formatted when they may change.
+ *
+ * @param list
+ *      timezones.
+ *
+ * @param format
+ *      format prepared by tz_format_prepare.
+ *
+ * @param from
+ *      the first tick.
+ *
+ * @param until
+ *      time at which the replay stops.
+ *
+ * @param step
+ *      seconds between ticks.
+ *
+ * @param cost
+ *      where to add cost of ticks (callback excluded).
+ *
+ * @param callback
+ *      function called for every tick or NULL.
+ *
+ * @param opaque
+ *      data for the callback.
+ *
+ * @return
+ *      nothing.
+ */
+static void
+simulate(struct convert_list *list,
+         const char *format,
+         time_t from,
+         time_t until,
+         long step,
+         struct convert_cost *cost,
+         convert_tick callback,
+         void *opaque)
+{
+    struct timespec origin = { from, 0 };
+    struct timespec now;
+    struct timespec begin;
+    struct timespec end;
+    struct tz_item *item;
+    struct tz_zone old;
+    char previous[TZ_SHORT];
+    int period = tz_format_period(format);
+    int changed;
+    int edge;
+    long ns;
+    time_t t;
+    int i;
+
+    for (i = 0; i < list->count; i++) {
+        memset(&list->items[i].zone, '\0', sizeof(struct tz_zone));
+        list->items[i].next = from;
+    }
+    tz_clock_set(TZ_CLOCK_FIXED, &origin, 1);
+
+    for (;;) {
+        tz_clock_now(&now);
+        if ((t = now.tv_sec) >= until)
+            break;
+
+        clock_gettime(CLOCK_MONOTONIC, &begin);
+        changed = 0;
+        edge = 0;
+
+        for (i = 0; i < list->count; i++) {
+            item = list->items + i;
+            if (!tz_zone_valid(&item->zone, t)) {
+                old = item->zone;
+                tz_item_zone(item, t);
+                if (t != from
+                    && (old.gmtoff != item->zone.gmtoff
+                        || old.isdst != item->zone.isdst))
+                    edge = 1;
+            }
+            list->gmtoff[i] = item->zone.gmtoff;
+        }
+
+        tz_civil_batch(t, list->count, list->gmtoff, list->tm);
+
+        for (i = 0; i < list->count; i++) {
+            item = list->items + i;
+            if (t < item->next)
+                continue;
+
+            strcpy(previous, tz_item_times(item)->time_short);
+            tz_item_format(item, tz_item_times(item), list->tm + i, 0,
+                           list->render, format);
+            item->next = tz_item_change(tz_item_times(item), t, period);
+            if (t == from
+                || strcmp(previous, tz_item_times(item)->time_short) != 0)
+                changed = 1;
+            cost->formatted++;
+        }
+
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        ns = (end.tv_sec - begin.tv_sec) * 1000000000L
+             + end.tv_nsec - begin.tv_nsec;
+        cost->ticks++;
+        cost->total += ns;
+        if (ns > cost->max)
+            cost->max = ns;
+        if (edge) {
+            cost->edges++;
+            cost->edge_total += ns;
+            if (ns > cost->edge_max)
+                cost->edge_max = ns;
+        }
+
+        if (callback != NULL)
+            callback(opaque, list, t, changed);
+
+        tz_clock_advance(step, 0);
+    }
+
+    tz_clock_set(TZ_CLOCK_REAL, NULL, 1);
+}
+
+
+/** Print time strings of all timezones if any of them changed. */
+static void
+print_tick(void *opaque, struct convert_list *list, time_t t, int changed)
+{
+    const char *separator = opaque;
+    int i;
+
+    if (!changed)
+        return;
+
+    printf("%ld", (long) t);
+    for (i = 0; i < list->count; i++) {
+        fputs(separator, stdout);
+        fputs(tz_item_times(list->items + i)->time_short, stdout);
+    }
+    putchar('\n');
+}
+
+
+/** Compare time string of the only timezone in the list with the one
+ * produced by the C library (TZ environment variable has to be set to the
+ * timezone).
+ */
+static void
+check_tick(void *opaque, struct convert_list *list, time_t t, int changed)
+{
+    struct convert_check *check = opaque;
+    const char *str = tz_item_times(list->items)->time_short;
+    struct tz_frac frac[TZ_FRAC];
+    char expected[TZ_SHORT];
+    struct tm tm;
+    int count;
+
+    localtime_r(&t, &tm);
+    strftime(expected, TZ_SHORT, check->format, &tm);
+    count = tz_format_frac_find(expected, frac);
+    tz_format_frac_set(expected, frac, count, 0);
+
+    check->checked++;
+    if (strcmp(str, expected) == 0)
+        return;
+
+    if (check->mismatches++ < 10) {
+        fprintf(stderr, "%s at %ld: \"%s\" instead of \"%s\"\n",
+                list->items->label, (long) t, str, expected);
+    }
+}
+
+
+/** Parse a range of time given as FROM:UNTIL[:STEP].
+ *
+ * @return
+ *      0 on success, -1 on error.
+ */
+static int
+parse_range(const char *str, time_t *from, time_t *until, long *step)
+{
+    char *end;
+
+    *from = strtoll(str, &end, 10);
+    if (end == str || *end != ':')
+        return -1;
+
+    str = end + 1;
+    *until = strtoll(str, &end, 10);
+    if (end == str)
+        return -1;
+
+    *step = 1;
+    if (*end == ':') {
+        str = end + 1;
+        *step = strtol(str, &end, 10);
+    }
+
+    return (*end == '\0' && *step > 0 && *from <= *until) ? 0 : -1;
+}
+
+
+/** Print cost of simulated ticks. */
+static void
+print_cost(const struct convert_cost *cost)
+{
+    printf("ticks\t%ld\n", cost->ticks);
+    printf("formatted\t%ld\n", cost->formatted);
+    printf("ns/tick\t%.1f\n",
+           (cost->ticks > 0) ? (double) cost->total / cost->ticks : 0.0);
+    printf("max ns/tick\t%ld\n", cost->max);
+    printf("transition ticks\t%ld\n", cost->edges);
+    printf("ns/transition tick\t%.1f\n",
+           (cost->edges > 0) ? (double) cost->edge_total / cost->edges
+                             : 0.0);
+    printf("max ns/transition tick\t%ld\n", cost->edge_max);
+}
+
+
+/** Parse a timestamp.
+ *
+ * @param str
+ *      seconds since epoch with optional fractional part.
+ *
+ * @param t
+ *      where to store seconds.
+ *
+ * @param nsec
+ *      where to store nanoseconds.
+ *
+ * @return
+ *      0 on success, -1 if str is not a timestamp.
+ */
+static int
+parse_time(const char *str, time_t *t, long *nsec)
+{
+    char *end;
+    long scale = 100000000;
+    int negative;
+
+    while (*str == ' ' || *str == '\t')
+        str++;
+    negative = *str == '-';
+
+    *t = strtoll(str, &end, 10);
+    *nsec = 0;
+    if (end == str)
+        return -1;
+
+    if (*end == '.') {
+        for (end++; *end >= '0' && *end <= '9'; end++, scale /= 10)
+            *nsec += (*end - '0') * scale;
+        if (negative && *nsec > 0) {
+            (*t)--;
+            *nsec = 1000000000 - *nsec;
+        }
+    }
+
+    return 0;
+}
+
+
+int
+main(int argc, char **argv)
+{
+    struct convert_list list;
+    struct tz_options options;
+    char format[TZ_FORMAT];
+    char line[LINE];
+    const char *separator = "\t";
+    char *config = NULL;
+    char *zones = NULL;
+    char *range = NULL;
+    int header = 0;
+    int want_long = 0;
+    int check = 0;
+    int bench = 0;
+    long years = 0;
+    long cycles = 0;
+    long threads = 0;
+    time_t from = 0;
+    time_t until = 0;
+    long step = 1;
+    FILE *file;
+    time_t t;
+    long nsec;
+    int opt;
+    int i;
+
+    /* time strings are formatted in the locale the plugin would use */
+    setlocale(LC_TIME, "");
+
+    memset(&list, '\0', sizeof(list));
+    tz_arena_init(&list.arena);
+    memset(&options, '\0', sizeof(options));
+    options.seconds = 1;
+
+    while ((opt = getopt(argc, argv, "ac:f:hls:BCK:M:S:T:")) != -1) {
+        switch (opt) {
+        case 'a':
+            list.all = 1;
+            break;
+        case 'c':
+            config = optarg;
+            break;
+        case 'f':
+            zones = optarg;
+            break;
+        case 'h':
+            header = 1;
+            break;
+        case 'l':
+            want_long = 1;
+            break;
+        case 's':
+            separator = optarg;
+            break;
+        case 'B':
+            bench = 1;
+            break;
+        case 'C':
+            check = 1;
+            break;
+        case 'K':
+            years = strtol(optarg, NULL, 10);
+            break;
+        case 'M':
+            cycles = strtol(optarg, NULL, 10);
+            break;
+        case 'S':
+            range = optarg;
+            break;
+        case 'T':
+            threads = strtol(optarg, NULL, 10);
+            break;
+        default:
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if ((range != NULL && parse_range(range, &from, &until, &step) < 0)
+        || (check && range == NULL)
+        || threads == 1 || threads < 0 || threads > TZ_THREADS_MAX) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    if (years > 0 || bench || threads > 0) {
+        long mismatches = 0;
+
+        if (years > 0) {
+            mismatches += tz_check_civil(years);
+            mismatches += tz_check_render(years);
+        }
+        if (threads > 0 && tz_check_parts((int) threads) != 0)
+            mismatches++;
+        if (bench) {
+            tz_bench_civil(stdout);
+            tz_bench_render(stdout);
+            tz_bench_frac(stdout);
+        }
+
+        return (mismatches > 0) ? 1 : 0;
+    }
+
+    if (config == NULL)
+        config = home_file(CONFIG_FILE);
+    if (zones == NULL)
+        zones = home_file(DATA_FILE);
+
+    if (config != NULL)
+        load_options(&options, config);
+
+    if (zones == NULL || (file = fopen(zones, "r")) == NULL) {
+        fprintf(stderr, "%s: cannot open timezones file\n", argv[0]);
+        return 1;
+    }
+    tz_store_read(file, convert_add, &list);
+    fclose(file);
+
+    if (cycles > 0)
+        return check_memory(&options, config, zones, cycles);
+
+    if (want_long) {
+        tz_format_prepare(tz_format_long(options), format, TZ_FORMAT);
+        list.render = TZ_RENDER_STRFTIME;
+    } else {
+        tz_format_prepare(tz_format_short(options), format, TZ_FORMAT);
+        list.render = tz_format_renderer(tz_format_short(options));
+    }
+
+    setvbuf(stdout, NULL, _IOFBF, 1 << 16);
+
+    if (header && !check) {
+        fputs("time", stdout);
+        for (i = 0; i < list.count; i++) {
+            fputs(separator, stdout);
+            fputs(list.items[i].label, stdout);
+        }
+        putchar('\n');
+    }
+
+    if (range != NULL) {
+        struct convert_cost cost;
+        struct convert_check result;
+        struct convert_list one;
+
+        memset(&cost, '\0', sizeof(cost));
+        if (!check) {
+            simulate(&list, format, from, until, step, &cost,
+                     print_tick, (void *) separator);
+            return 0;
+        }
+
+        simulate(&list, format, from, until, step, &cost, NULL, NULL);
+        print_cost(&cost);
+
+        /* the C library needs TZ set, so check one timezone at a time */
+        memset(&result, '\0', sizeof(result));
+        result.format = format;
+        for (i = 0; i < list.count; i++) {
+            one = list;
+            one.count = 1;
+            one.items = list.items + i;
+            one.gmtoff = list.gmtoff + i;
+            one.tm = list.tm + i;
+
+            setenv("TZ", list.items[i].timezone, 1);
+            tzset();
+            memset(&cost, '\0', sizeof(cost));
+            simulate(&one, format, from, until, step, &cost,
+                     check_tick, &result);
+        }
+        printf("checked\t%ld\n", result.checked);
+        printf("mismatches\t%ld\n", result.mismatches);
+
+        return (result.mismatches > 0) ? 1 : 0;
+    }
+
+    while (fgets(line, LINE, stdin) != NULL) {
+        char *nl;
+
+        if ((nl = strchr(line, '\n')) != NULL)
+            *nl = '\0';
+
+        if (parse_time(line, &t, &nsec) < 0)
+            continue;
+
+        for (i = 0; i < list.count; i++) {
+            tz_item_zone(list.items + i, t);
+            list.gmtoff[i] = list.items[i].zone.gmtoff;
+        }
+
+        tz_civil_batch(t, list.count, list.gmtoff, list.tm);
+
+        fputs(line, stdout);
+        for (i = 0; i < list.count; i++) {
+            struct tz_item *item = list.items + i;
+
+            tz_item_format(item, tz_item_times(item), list.tm + i, nsec,
+                           list.render, format);
+            fputs(separator, stdout);
+            fputs(tz_item_times(item)->time_short, stdout);
+        }
+        putchar('\n');
+    }
+
+    return 0;
+}
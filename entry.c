@@ -0,0 +1,334 @@
+/*
+ * List of timezones independent of GTK+.
+ * Copyright (C) 2026 Jiri Denemark
+ *
+ * This file is part of gkrellm-tz.
+ *
+ * gkrellm-tz is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+/** @file
+ * List of timezones independent of GTK+.
+ * @author Jiri Denemark
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "entry.h"
+#include "store.h"
+#include "mem.h"
+
+
+/** Initialize an empty list.
+ *
+ * @param entries
+ *      list of timezones.
+ *
+ * @param size
+ *      size of structures allocated for entries, at least
+ *      sizeof(struct tz_entry).
+ *
+ * @return
+ *      nothing.
+ */
+void
+tz_entries_init(struct tz_entries *entries, size_t size)
+{
+    memset((void *) entries, '\0', sizeof(struct tz_entries));
+    tz_arena_init(&entries->arena);
+    entries->size = size;
+}
+
+
+/** Free all memory of a list, the list is empty afterwards.
+ *
+ * @param entries
+ *      list of timezones.
+ *
+ * @return
+ *      nothing.
+ */
+void
+tz_entries_free(struct tz_entries *entries)
+{
+    struct tz_batch *batch = &entries->batch;
+
+    tz_entries_clean(entries);
+    tz_arena_free(&entries->arena);
+
+    tz_mem_free(batch->all);
+    tz_mem_free(batch->items);
+    tz_mem_free(batch->tz);
+    tz_mem_free(batch->gmtoff);
+    tz_mem_free(batch->tm);
+    tz_mem_free(batch->heap);
+    tz_entries_init(entries, entries->size);
+}
+
+
+/** Remove all entries from a list. Their memory is kept for entries added
+ * later.
+ *
+ * @param entries
+ *      list of timezones.
+ *
+ * @return
+ *      nothing.
+ */
+void
+tz_entries_clean(struct tz_entries *entries)
+{
+    struct tz_batch *batch = &entries->batch;
+
+    tz_mem_free(batch->rings);
+    batch->rings = NULL;
+    batch->rings_count = 0;
+
+    tz_arena_reset(&entries->arena);
+    entries->first = NULL;
+    entries->last = NULL;
+    batch->count = 0;
+    batch->total = 0;
+    batch->page = 0;
+    batch->pending = 0;
+}
+
+
+/** Add an enabled entry to the batch.
+ *
+ * @param batch
+ *      batch of enabled timezones.
+ *
+ * @param entry
+ *      entry to be added.
+ *
+ * @return
+ *      0 on success, -1 when memory could not be allocated.
+ */
+static int
+tz_batch_add(struct tz_batch *batch, struct tz_entry *entry)
+{
+    if (batch->total == batch->size) {
+        int size = (batch->size > 0) ? 2 * batch->size : 16;
+        void *p;
+
+        p = tz_mem_realloc(batch->all, size * sizeof(*batch->all));
+        if (p == NULL)
+            return -1;
+        batch->all = p;
+
+        p = tz_mem_realloc(batch->items, size * sizeof(*batch->items));
+        if (p == NULL)
+            return -1;
+        batch->items = p;
+
+        p = tz_mem_realloc(batch->tz, size * sizeof(*batch->tz));
+        if (p == NULL)
+            return -1;
+        batch->tz = p;
+
+        p = tz_mem_realloc(batch->gmtoff, size * sizeof(*batch->gmtoff));
+        if (p == NULL)
+            return -1;
+        batch->gmtoff = p;
+
+        p = tz_mem_realloc(batch->tm, size * sizeof(*batch->tm));
+        if (p == NULL)
+            return -1;
+        batch->tm = p;
+
+        p = tz_mem_realloc(batch->heap, size * sizeof(*batch->heap));
+        if (p == NULL)
+            return -1;
+        batch->heap = p;
+
+        batch->size = size;
+    }
+
+    batch->all[batch->total++] = entry;
+    batch->tz[batch->count] = &entry->tz;
+    batch->items[batch->count++] = entry;
+
+    return 0;
+}
+
+
+/** Add a timezone to the end of a list. Timezone files and rules are
+ * loaded once for all entries with the same timezone. The batch may be
+ * reallocated, so nothing may be converting it.
+ *
+ * @param entries
+ *      list of timezones.
+ *
+ * @param enabled
+ *      nonzero if the timezone is enabled.
+ *
+ * @param label
+ *      label of the timezone, NULL means the timezone itself.
+ *
+ * @param timezone
+ *      timezone.
+ *
+ * @return
+ *      the new entry or NULL if the timezone is empty, its label is
+ *      already in the list, or memory could not be allocated. Rejected
+ *      entries stay in the arena until the list is cleaned.
+ */
+struct tz_entry *
+tz_entries_add(struct tz_entries *entries,
+               int enabled,
+               const char *label,
+               const char *timezone)
+{
+    struct tz_arena *arena = &entries->arena;
+    struct tz_entry *entry;
+    struct tz_entry *same = NULL;
+
+    if (timezone == NULL || *timezone == '\0')
+        return NULL;
+
+    if (label == NULL)
+        label = timezone;
+
+    /* interned strings are equal iff they are the same pointer */
+    if ((label = tz_arena_intern(arena, label)) == NULL
+        || (timezone = tz_arena_intern(arena, timezone)) == NULL)
+        return NULL;
+
+    for (entry = entries->first; entry != NULL; entry = entry->next) {
+        if (entry->tz.label == label)
+            return NULL;
+        if (entry->tz.timezone == timezone)
+            same = entry;
+    }
+
+    entry = (struct tz_entry *) tz_arena_alloc(arena, entries->size);
+    if (entry == NULL)
+        return NULL;
+
+    memset((void *) entry, '\0', entries->size);
+    tz_item_init(&entry->tz);
+    entry->tz.enabled = enabled;
+    entry->tz.label = label;
+    entry->tz.timezone = timezone;
+    if (same != NULL) {
+        entry->tz.fixed = same->tz.fixed;
+        entry->tz.tzfile = same->tz.tzfile;
+        entry->tz.rule = same->tz.rule;
+    } else if ((entry->tz.fixed = tz_zone_fixed(arena, timezone)) == NULL) {
+        entry->tz.tzfile = tz_tzfile_load(arena, timezone);
+        if (entry->tz.tzfile == NULL)
+            entry->tz.rule = tz_rule_parse(arena, timezone);
+    }
+
+    if (enabled && tz_batch_add(&entries->batch, entry) < 0)
+        return NULL;
+
+    entry->prev = entries->last;
+    entries->last = entry;
+    if (entry->prev == NULL)
+        entries->first = entry;
+    else
+        entry->prev->next = entry;
+
+    return entry;
+}
+
+
+/** Write all timezones of a list to a file (see tz_store_read).
+ *
+ * @param entries
+ *      list of timezones.
+ *
+ * @param file
+ *      file to write to.
+ *
+ * @return
+ *      nothing.
+ */
+void
+tz_entries_store(struct tz_entries *entries, FILE *file)
+{
+    struct tz_entry *entry;
+
+    for (entry = entries->first; entry != NULL; entry = entry->next)
+        tz_store_write(file, entry->tz.enabled, entry->tz.timezone,
+                       entry->tz.label);
+}
+
+
+/** Look up offsets of all timezones in the batch valid at a given time.
+ *
+ * @param batch
+ *      batch of enabled timezones.
+ *
+ * @param t
+ *      time.
+ *
+ * @return
+ *      nothing.
+ */
+void
+tz_batch_zones(struct tz_batch *batch, time_t t)
+{
+    int i;
+
+    for (i = 0; i < batch->count; i++) {
+        tz_item_zone(batch->tz[i], t);
+        batch->gmtoff[i] = batch->tz[i]->zone.gmtoff;
+    }
+}
+
+
+/** Make sure all entries in the batch have their rings of time strings.
+ * Rings are only allocated for entries in the batch (i.e., on the current
+ * page), so this has to be called whenever the batch changes and nothing
+ * is converting it. If the rings cannot be allocated, the batch is
+ * shortened to the entries which have them.
+ *
+ * @param batch
+ *      batch of enabled timezones.
+ *
+ * @return
+ *      nothing.
+ */
+void
+tz_batch_rings(struct tz_batch *batch)
+{
+    struct tz_times *rings;
+    int i;
+
+    if (batch->count != batch->rings_count) {
+        if (batch->count == 0) {
+            tz_mem_free(batch->rings);
+            rings = NULL;
+        } else {
+            rings = tz_mem_realloc(batch->rings, batch->count * TZ_RING
+                                                 * sizeof(*rings));
+        }
+
+        if (rings != NULL || batch->count == 0) {
+            batch->rings = rings;
+            batch->rings_count = batch->count;
+        } else {
+            batch->count = batch->rings_count;
+        }
+    }
+
+    for (i = 0; i < batch->count; i++)
+        batch->tz[i]->ring = batch->rings + i * TZ_RING;
+}
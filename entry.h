@@ -0,0 +1,122 @@
+/*
+ * List of timezones independent of GTK+.
+ * Copyright (C) 2026 Jiri Denemark
+ *
+ * This file is part of gkrellm-tz.
+ *
+ * gkrellm-tz is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+/** @file
+ * List of timezones independent of GTK+.
+ * Timezones are kept in the order they were added, enabled ones are also
+ * collected in a batch converted together. The plugin embeds list entries
+ * in its own items with panels (see struct tz_list_item), so that
+ * gkrellm-tz-convert can exercise the same code without GTK+.
+ * @author Jiri Denemark
+ */
+
+#ifndef ENTRY_H
+#define ENTRY_H
+
+#include <stdio.h>
+#include <stddef.h>
+#include <time.h>
+
+#include "arena.h"
+#include "item.h"
+
+
+/** Timezone list entry.
+ * Users of the list may put it at the beginning of a larger structure and
+ * tell tz_entries_init its size; the rest of the structure is zeroed when
+ * an entry is added.
+ */
+struct tz_entry {
+    /** Pointer to the previous entry in the list. */
+    struct tz_entry *prev;
+    /** Pointer to the next entry in the list. */
+    struct tz_entry *next;
+    /** Timezone description and current time. */
+    struct tz_item tz;
+};
+
+
+/** Enabled timezones converted together.
+ * Offsets are kept in a separate array so that all entries can be
+ * converted to broken-down time in a single pass (see tz_civil_batch).
+ * Only entries on the current page are in the batch (see tz_list_page).
+ */
+struct tz_batch {
+    /** Number of entries in the batch. */
+    int count;
+    /** Number of entries the arrays can hold. */
+    int size;
+    /** Number of all enabled entries. */
+    int total;
+    /** Current page. */
+    int page;
+    /** All enabled entries. */
+    struct tz_entry **all;
+    /** Entries in the batch. */
+    struct tz_entry **items;
+    /** Timezones of entries in the batch (see tz_item_convert). */
+    struct tz_item **tz;
+    /** Offsets from UTC of all entries. */
+    long *gmtoff;
+    /** Broken-down time of all entries. */
+    struct tm *tm;
+    /** Entries in the batch ordered by their due time in a binary
+     * min-heap so that only those whose strings change are touched every
+     * second (maintained by the plugin). */
+    struct tz_entry **heap;
+    /** Number of entries in the heap. */
+    int pending;
+    /** Rings of time strings of entries in the batch (see struct
+     * tz_item), TZ_RING elements per entry. */
+    struct tz_times *rings;
+    /** Number of entries the rings were allocated for. */
+    int rings_count;
+};
+
+
+/** List of timezones. */
+struct tz_entries {
+    /** Memory for entries and their strings. */
+    struct tz_arena arena;
+    /** Pointer to the first entry in the list. */
+    struct tz_entry *first;
+    /** Pointer to the last entry in the list. */
+    struct tz_entry *last;
+    /** Enabled entries. */
+    struct tz_batch batch;
+    /** Size of structures allocated for entries. */
+    size_t size;
+};
+
+
+void tz_entries_init(struct tz_entries *entries, size_t size);
+void tz_entries_free(struct tz_entries *entries);
+void tz_entries_clean(struct tz_entries *entries);
+struct tz_entry *tz_entries_add(struct tz_entries *entries,
+                                int enabled,
+                                const char *label,
+                                const char *timezone);
+void tz_entries_store(struct tz_entries *entries, FILE *file);
+void tz_batch_zones(struct tz_batch *batch, time_t t);
+void tz_batch_rings(struct tz_batch *batch);
+
+#endif
@@ -34,6 +34,22 @@
 # define TOOLTIP_API 0
 #endif
 
+#if GLIB_CHECK_VERSION(2,32,0)
+# define WORKER_API 1
+#else
+# define WORKER_API 0
+#endif
+
+#ifdef __linux__
+# include <sys/timerfd.h>
+#endif
+
+#ifdef TFD_TIMER_CANCEL_ON_SET
+# define JUMP_API 1
+#else
+# define JUMP_API 0
+#endif
+
 #define GTK_DISABLE_DEPRECATED 1
 
 #endif
@@ -0,0 +1,362 @@
+/*
+ * Time format extensions.
+ * Copyright (C) 2026 Jiri Denemark
+ *
+ * This file is part of gkrellm-tz.
+ *
+ * gkrellm-tz is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/** @file
+ * Time format extensions.
+ * @author Jiri Denemark
+ */
+
+#include <langinfo.h>
+#include <stddef.h>
+#include <string.h>
+#include <time.h>
+
+#include "options.h"
+#include "format.h"
+
+/** Number of digits "%f" stands for. */
+#define FRAC_DEFAULT    3
+/** Maximum length of AM/PM strings the 12-hour renderers can write. */
+#define AMPM_MAX        15
+
+/** AM and PM strings of the current locale (see tz_format_renderer). */
+static char format_ampm[2][AMPM_MAX + 1];
+/** Lengths of format_ampm strings. */
+static size_t format_ampm_len[2];
+
+
+/** Prepare format string for strftime.
+ * Fractional seconds are replaced with marks, everything else is copied
+ * unchanged.
+ *
+ * @param format
+ *      format string.
+ *
+ * @param buf
+ *      where to store prepared format.
+ *
+ * @param size
+ *      size of the buffer.
+ *
+ * @return
+ *      number of fractional second fields in the format.
+ */
+int
+tz_format_prepare(const char *format, char *buf, size_t size)
+{
+    const char *p = format;
+    size_t len = 0;
+    int fields = 0;
+    int digits;
+    int i;
+
+    if (size == 0)
+        return 0;
+
+    while (*p != '\0' && len < size - 1) {
+        if (p[0] == '%' && p[1] == 'f') {
+            digits = FRAC_DEFAULT;
+            p += 2;
+        } else if (p[0] == '%' && p[1] >= '1' && p[1] <= '9' && p[2] == 'f') {
+            digits = p[1] - '0';
+            p += 3;
+        } else {
+            if (p[0] == '%' && p[1] != '\0' && len < size - 2)
+                buf[len++] = *p++;
+            buf[len++] = *p++;
+            continue;
+        }
+
+        for (i = 1; i <= digits && len < size - 1; i++)
+            buf[len++] = TZ_FRAC_MARK + i;
+        fields++;
+    }
+    buf[len] = '\0';
+
+    return fields;
+}
+
+
+/** Find fractional second marks in a string formatted by strftime.
+ *
+ * @param str
+ *      formatted string.
+ *
+ * @param frac
+ *      array of TZ_FRAC elements where to store positions of the marks.
+ *
+ * @return
+ *      number of marks found.
+ */
+int
+tz_format_frac_find(const char *str, struct tz_frac *frac)
+{
+    int count = 0;
+    int i;
+
+    for (i = 0; str[i] != '\0' && i <= 255 && count < TZ_FRAC; i++) {
+        if (str[i] > TZ_FRAC_MARK && str[i] <= TZ_FRAC_MARK + 9) {
+            frac[count].pos = i;
+            frac[count].digit = str[i] - TZ_FRAC_MARK;
+            count++;
+        }
+    }
+
+    return count;
+}
+
+
+/** Write fractional second digits into a time string.
+ *
+ * @param str
+ *      formatted string.
+ *
+ * @param frac
+ *      positions of the digits as found by tz_format_frac_find.
+ *
+ * @param count
+ *      number of digits.
+ *
+ * @param nsec
+ *      nanoseconds.
+ *
+ * @return
+ *      nonzero if any digit changed.
+ */
+int
+tz_format_frac_set(char *str,
+                   const struct tz_frac *frac,
+                   int count,
+                   long nsec)
+{
+    static const long scale[10] = {
+        1000000000, 100000000, 10000000, 1000000, 100000,
+        10000, 1000, 100, 10, 1
+    };
+    int changed = 0;
+    char digit;
+    int i;
+
+    for (i = 0; i < count; i++) {
+        digit = '0' + nsec / scale[frac[i].digit] % 10;
+        changed |= str[frac[i].pos] != digit;
+        str[frac[i].pos] = digit;
+    }
+
+    return changed;
+}
+
+
+/** Find how often strings formatted with a given format may change.
+ * Only changes caused by the passing of time are considered, changes of
+ * local time type (%Z, %z, and any field at a transition) are left to the
+ * caller. Unknown conversions are assumed to change every second.
+ *
+ * @param format
+ *      format prepared by tz_format_prepare.
+ *
+ * @return
+ *      period in seconds (1, 60, 3600, or 86400) aligned to local time,
+ *      or 0 if the strings only change with local time type.
+ */
+int
+tz_format_period(const char *format)
+{
+    const char *p;
+    int period = 0;
+    int field;
+
+    for (p = format; *p != '\0'; p++) {
+        if (*p > TZ_FRAC_MARK && *p <= TZ_FRAC_MARK + 9)
+            return 1;
+        if (*p != '%')
+            continue;
+
+        /* flags, field width, and E or O modifiers */
+        p++;
+        while (*p == '_' || *p == '-' || *p == '0' || *p == '^' || *p == '#'
+               || (*p >= '1' && *p <= '9') || *p == 'E' || *p == 'O')
+            p++;
+
+        switch (*p) {
+        case '\0':
+            return period;
+
+        case '%':
+        case 'n':
+        case 't':
+        case 'z':
+        case 'Z':
+            continue;
+
+        case 'M':
+        case 'R':
+            field = 60;
+            break;
+
+        case 'H':
+        case 'I':
+        case 'k':
+        case 'l':
+        case 'p':
+        case 'P':
+            field = 3600;
+            break;
+
+        case 'a':
+        case 'A':
+        case 'b':
+        case 'B':
+        case 'h':
+        case 'C':
+        case 'd':
+        case 'D':
+        case 'e':
+        case 'F':
+        case 'g':
+        case 'G':
+        case 'j':
+        case 'm':
+        case 'u':
+        case 'U':
+        case 'V':
+        case 'w':
+        case 'W':
+        case 'x':
+        case 'y':
+        case 'Y':
+            field = 86400;
+            break;
+
+        default:
+            return 1;
+        }
+
+        if (period == 0 || field < period)
+            period = field;
+    }
+
+    return period;
+}
+
+
+/** Select a renderer for a given format.
+ * Built-in short formats are rendered directly unless the current locale
+ * makes strftime produce them differently (e.g., %r not being
+ * "%I:%M:%S %p"). AM/PM strings of the current locale are cached for the
+ * renderers, so this has to be called from the main thread whenever the
+ * format or locale changes, before tz_format_render is used.
+ *
+ * @param format
+ *      time format (not prepared by tz_format_prepare).
+ *
+ * @return
+ *      renderer to be passed to tz_format_render.
+ */
+enum tz_render
+tz_format_renderer(const char *format)
+{
+    enum tz_render renderer;
+    const char *str;
+    int i;
+
+    if (strcmp(format, TZ_SHORT_FORMAT_24s) == 0)
+        return TZ_RENDER_24s;
+    else if (strcmp(format, TZ_SHORT_FORMAT_24) == 0)
+        return TZ_RENDER_24;
+    else if (strcmp(format, TZ_SHORT_FORMAT_12s) == 0)
+        renderer = TZ_RENDER_12s;
+    else if (strcmp(format, TZ_SHORT_FORMAT_12) == 0)
+        renderer = TZ_RENDER_12;
+    else
+        return TZ_RENDER_STRFTIME;
+
+    if (renderer == TZ_RENDER_12s
+        && strcmp(nl_langinfo(T_FMT_AMPM), "%I:%M:%S %p") != 0)
+        return TZ_RENDER_STRFTIME;
+
+    for (i = 0; i < 2; i++) {
+        str = nl_langinfo((i == 0) ? AM_STR : PM_STR);
+        if ((format_ampm_len[i] = strlen(str)) > AMPM_MAX)
+            return TZ_RENDER_STRFTIME;
+        memcpy(format_ampm[i], str, format_ampm_len[i] + 1);
+    }
+
+    return renderer;
+}
+
+
+/** Write a two digit number. */
+static char *
+format_digits(char *p, int value)
+{
+    p[0] = '0' + value / 10;
+    p[1] = '0' + value % 10;
+    return p + 2;
+}
+
+
+/** Render a built-in short format. The result is the same as that of
+ * strftime with the corresponding format.
+ *
+ * @param renderer
+ *      renderer selected by tz_format_renderer (not TZ_RENDER_STRFTIME).
+ *
+ * @param buf
+ *      buffer of TZ_SHORT bytes.
+ *
+ * @param tm
+ *      broken-down time with tm_zone set.
+ *
+ * @return
+ *      nothing.
+ */
+void
+tz_format_render(enum tz_render renderer, char *buf, const struct tm *tm)
+{
+    int twelve = renderer == TZ_RENDER_12s || renderer == TZ_RENDER_12;
+    int pm = tm->tm_hour >= 12;
+    size_t len;
+    char *p = buf;
+
+    if (twelve)
+        p = format_digits(p, (tm->tm_hour % 12 == 0) ? 12 : tm->tm_hour % 12);
+    else
+        p = format_digits(p, tm->tm_hour);
+    *p++ = ':';
+    p = format_digits(p, tm->tm_min);
+
+    if (renderer == TZ_RENDER_24s || renderer == TZ_RENDER_12s) {
+        *p++ = ':';
+        p = format_digits(p, tm->tm_sec);
+    }
+
+    if (twelve) {
+        *p++ = ' ';
+        memcpy(p, format_ampm[pm], format_ampm_len[pm]);
+        p += format_ampm_len[pm];
+    }
+
+    *p++ = ' ';
+    len = strnlen(tm->tm_zone, TZ_SHORT - (p - buf) - 1);
+    memcpy(p, tm->tm_zone, len);
+    p[len] = '\0';
+}
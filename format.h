@@ -0,0 +1,80 @@
+/*
+ * Time format extensions.
+ * Copyright (C) 2026 Jiri Denemark
+ *
+ * This file is part of gkrellm-tz.
+ *
+ * gkrellm-tz is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/** @file
+ * Time format extensions.
+ * Format strings may contain "%f" (milliseconds) or "%1f" ... "%9f"
+ * (given number of fractional second digits) in addition to everything
+ * supported by strftime. Such formats are prepared by replacing fractional
+ * seconds with marks which survive strftime and are later overwritten with
+ * actual digits, so fractional seconds may change without calling strftime
+ * again.
+ * @author Jiri Denemark
+ */
+
+#ifndef FORMAT_H
+#define FORMAT_H
+
+#include <stddef.h>
+#include <time.h>
+
+/** Maximum number of fractional second digits in a time string. */
+#define TZ_FRAC             16
+/** Mark for the first fractional second digit, the n-th digit is marked
+ * by TZ_FRAC_MARK + n. */
+#define TZ_FRAC_MARK        0x10
+
+
+/** Renderers of time strings. */
+enum tz_render {
+    /** Generic strftime. */
+    TZ_RENDER_STRFTIME,
+    /** TZ_SHORT_FORMAT_24s. */
+    TZ_RENDER_24s,
+    /** TZ_SHORT_FORMAT_24. */
+    TZ_RENDER_24,
+    /** TZ_SHORT_FORMAT_12s. */
+    TZ_RENDER_12s,
+    /** TZ_SHORT_FORMAT_12. */
+    TZ_RENDER_12
+};
+
+
+/** Position of a fractional second digit in a time string. */
+struct tz_frac {
+    /** Offset of the digit in the string. */
+    unsigned char pos;
+    /** Which digit after the decimal point it is (1--9). */
+    unsigned char digit;
+};
+
+
+int tz_format_prepare(const char *format, char *buf, size_t size);
+int tz_format_frac_find(const char *str, struct tz_frac *frac);
+int tz_format_frac_set(char *str,
+                       const struct tz_frac *frac,
+                       int count,
+                       long nsec);
+int tz_format_period(const char *format);
+enum tz_render tz_format_renderer(const char *format);
+void tz_format_render(enum tz_render renderer, char *buf, const struct tm *tm);
+
+#endif
@@ -33,7 +33,11 @@
 
 #include "features.h"
 #include "list.h"
+#include "clock.h"
 #include "config.h"
+#include "planner.h"
+#include "jump.h"
+#include "mem.h"
 
 #define CONFIG_TAB      "Timezone"
 #define CONFIG_KEYWORD  "gkrellm-tz"
@@ -41,15 +45,31 @@
 
 
 static struct tz_plugin plugin;
+static struct tz_jump *jump;
+
+
+/** Switch to a given page of timezones and draw it immediately. */
+static void
+show_page(int page)
+{
+    struct timespec now;
+
+    tz_list_page(&plugin, page);
+    tz_list_now(&plugin, &now);
+    tz_list_update(&plugin, &now);
+    tz_plugin_update(&plugin);
+}
 
 
 static gint
 panel_expose_event(GtkWidget *widget, GdkEventExpose *ev)
 {
+    struct tz_entry *entry;
     struct tz_list_item *item;
 
-    for (item = plugin.first; item != NULL; item = item->next) {
-        if (item->tz.enabled && widget == item->panel->drawing_area) {
+    for (entry = plugin.list.first; entry != NULL; entry = entry->next) {
+        item = tz_list_item_of(entry);
+        if (entry->tz.enabled && widget == item->panel->drawing_area) {
             gdk_draw_pixmap(widget->window,
                             widget->style->fg_gc[GTK_WIDGET_STATE(widget)],
                             item->panel->pixmap, ev->area.x, ev->area.y,
@@ -67,36 +87,182 @@ panel_click_event(GtkWidget *widget,
                   GdkEventButton *ev,
                   gpointer data)
 {
-    if (ev->button == 3)
+    if (ev->button == 1)
+        tz_planner_show(&plugin);
+    else if (ev->button == 3)
         gkrellm_open_config_window(plugin.monitor);
 }
 
 
+static gboolean
+panel_scroll_event(GtkWidget *widget,
+                   GdkEventScroll *ev,
+                   gpointer data)
+{
+    if (ev->direction == GDK_SCROLL_UP)
+        show_page(plugin.list.batch.page - 1);
+    else if (ev->direction == GDK_SCROLL_DOWN)
+        show_page(plugin.list.batch.page + 1);
+
+    return TRUE;
+}
+
+
+static gboolean
+panel_crossing_event(GtkWidget *widget,
+                     GdkEventCrossing *ev,
+                     gpointer data)
+{
+    struct tz_entry *entry = NULL;
+
+    if (ev->type == GDK_ENTER_NOTIFY) {
+        for (entry = plugin.list.first; entry != NULL; entry = entry->next) {
+            if (entry->tz.enabled
+                && widget == tz_list_item_of(entry)->panel->drawing_area)
+                break;
+        }
+    }
+    tz_list_hover(&plugin, (entry != NULL) ? tz_list_item_of(entry) : NULL);
+
+    return FALSE;
+}
+
+
 static void
 update(void)
 {
-    if (gkrellm_ticks()->second_tick)
-        tz_list_update(&plugin, mktime(gkrellm_get_current_time()));
+    struct timespec now;
+    struct timespec tick;
+    struct timespec done;
+
+    tz_list_now(&plugin, &now);
+    if (now.tv_sec != plugin.now.tv_sec) {
+        /* measure how late the new second gets to the panels */
+        tz_clock_real(&tick);
+        tz_list_update(&plugin, &now);
+        tz_plugin_update(&plugin);
+        tz_clock_real(&done);
+        tz_stats_tick(&plugin.stats, &tick, &done);
+        tz_mem_tick();
+        return;
+    }
+
+    if (plugin.frac)
+        tz_list_frac(&plugin, &now);
 
     tz_plugin_update(&plugin);
 }
 
 
+/** Show current time right after the realtime clock was stepped instead
+ * of waiting for the next update. */
+static void
+clock_jumped(gpointer data)
+{
+    tz_list_resync(&plugin);
+}
+
+
+static gboolean
+subsecond_update(gpointer data)
+{
+    update();
+    return TRUE;
+}
+
+
+/** (Re)start or stop timer for redrawing fractional seconds according to
+ * plugin options.
+ */
+static void
+subsecond_timer(void)
+{
+    static guint timer = 0;
+    char format[TZ_FORMAT];
+
+    if (timer != 0) {
+        g_source_remove(timer);
+        timer = 0;
+    }
+
+    if (plugin.options.subsecond_hz > 0
+        && tz_format_prepare(tz_format_short(plugin.options),
+                             format, TZ_FORMAT) > 0) {
+        timer = g_timeout_add(1000 / plugin.options.subsecond_hz,
+                              subsecond_update, NULL);
+    }
+}
+
+
+static gboolean
+rotate_update(gpointer data)
+{
+    show_page(plugin.list.batch.page + 1);
+    return TRUE;
+}
+
+
+/** (Re)start or stop timer for rotating pages according to plugin
+ * options.
+ */
+static void
+rotate_timer(void)
+{
+    static guint timer = 0;
+
+    if (timer != 0) {
+        g_source_remove(timer);
+        timer = 0;
+    }
+
+    if (plugin.options.page_size > 0 && plugin.options.page_rotate > 0) {
+        timer = g_timeout_add(1000 * plugin.options.page_rotate,
+                              rotate_update, NULL);
+    }
+}
+
+
+/** Open or close shared memory according to plugin options. */
+static void
+publish_setup(void)
+{
+    if (plugin.options.publish && plugin.shm == NULL) {
+        plugin.shm = tz_shm_open(NULL);
+    } else if (!plugin.options.publish && plugin.shm != NULL) {
+        tz_shm_close(plugin.shm);
+        plugin.shm = NULL;
+    }
+}
+
+
 static void
 create(GtkWidget *vbox, gint first_create)
 {
     if (first_create) {
         plugin.vbox = vbox;
+        if (plugin.worker == NULL)
+            plugin.worker = tz_worker_new(&plugin);
+        if (jump == NULL)
+            jump = tz_jump_new(clock_jumped, NULL);
 
         tz_list_clean(&plugin);
+        tz_worker_threads(plugin.worker, plugin.options.threads);
         tz_list_load(&plugin);
+        subsecond_timer();
+        rotate_timer();
+        publish_setup();
+        show_page(0);
     } else {
-        struct tz_list_item *item;
+        struct tz_entry *entry;
 
-        for (item = plugin.first; item != NULL; item = item->next) {
-            if (item->tz.enabled)
-                tz_panel_create(&plugin, item);
+        tz_atlas_free(plugin.atlas);
+        plugin.atlas = NULL;
+
+        for (entry = plugin.list.first; entry != NULL; entry = entry->next) {
+            if (entry->tz.enabled)
+                tz_panel_create(&plugin, tz_list_item_of(entry));
         }
+        show_page(plugin.list.batch.page);
     }
 }
 
@@ -113,19 +279,36 @@ apply(void)
 {
     tz_list_clean(&plugin);
     tz_config_apply(&plugin);
+    if (!plugin.options.glyph_cache) {
+        tz_atlas_free(plugin.atlas);
+        plugin.atlas = NULL;
+    }
+    tz_worker_threads(plugin.worker, plugin.options.threads);
     tz_list_store(&plugin);
+    subsecond_timer();
+    rotate_timer();
+    publish_setup();
+    /* the panels are drawn now rather than with the next second, which
+     * never comes while the time is pinned */
+    show_page(0);
 }
 
 
 static void
 save(FILE *f)
 {
-    fprintf(f, "%s options %d %d %d %d\n",
+    fprintf(f, "%s options %d %d %d %d %d %d %d %d %d %d\n",
             CONFIG_KEYWORD,
             plugin.options.twelve_hour,
             plugin.options.seconds,
             plugin.options.custom,
-            plugin.options.align);
+            plugin.options.align,
+            plugin.options.glyph_cache,
+            plugin.options.subsecond_hz,
+            plugin.options.publish,
+            plugin.options.page_size,
+            plugin.options.page_rotate,
+            plugin.options.threads);
 
     fprintf(f, "%s format_short \"%s\"\n",
             CONFIG_KEYWORD,
@@ -137,56 +320,22 @@ save(FILE *f)
 }
 
 
-static char *
-strdup_quoted(char *str)
-{
-    int len;
-
-    if (str == NULL)
-        return NULL;
-
-    if (*str == '"')
-        str++;
-
-    len = strlen(str);
-    if (str[len - 1] == '"')
-        str[len - 1] = '\0';
-
-    return strdup(str);
-}
-
 static void
 load(gchar *line)
 {
-    char config[32];
-    char value[CFG_BUFSIZE];
+    tz_options_load(&plugin.options, line);
+}
 
-    if (sscanf(line, "%31s %[^\n]", config, value) != 2)
-        return;
 
-    if (strcmp(config, "options") == 0) {
-        int twelve_hour;
-        int seconds;
-        int custom;
-        int align;
-
-        sscanf(value, "%d %d %d %d", &twelve_hour, &seconds, &custom, &align);
-        plugin.options.twelve_hour = twelve_hour != 0;
-        plugin.options.seconds = seconds != 0;
-        plugin.options.custom = custom != 0;
-        switch (align) {
-        case TA_LEFT:   plugin.options.align = TA_LEFT; break;
-        case TA_CENTER: plugin.options.align = TA_CENTER; break;
-        case TA_RIGHT:  plugin.options.align = TA_RIGHT; break;
-        default:        plugin.options.align = TA_LEFT; break;
-        }
-    } else if (strcmp(config, "format_short") == 0) {
-        if (*value != '\0')
-            plugin.options.format_short = strdup_quoted(value);
-    } else if (strcmp(config, "format_long") == 0) {
-        if (*value != '\0')
-            plugin.options.format_long = strdup_quoted(value);
-    }
+/** Release resources visible outside of GKrellM and stop threads when
+ * the plugin is disabled or GKrellM exits. */
+static void
+plugin_exit(void)
+{
+    tz_shm_close(plugin.shm);
+    plugin.shm = NULL;
+    tz_worker_free(plugin.worker);
+    plugin.worker = NULL;
 }
 
 
@@ -217,15 +366,40 @@ static GkrellmMonitor plugin_mon = {
 GkrellmMonitor *
 gkrellm_init_plugin(void)
 {
+    const char *charset;
+
     plugin.options.twelve_hour = 0;
     plugin.options.seconds = 1;
     plugin.options.custom = 0;
     plugin.options.format_short = NULL;
     plugin.options.format_long = NULL;
     plugin.options.align = TA_LEFT;
-    plugin.first = NULL;
-    plugin.last = NULL;
+    plugin.options.glyph_cache = 0;
+    plugin.options.subsecond_hz = 0;
+    plugin.options.publish = 0;
+    plugin.options.page_size = 0;
+    plugin.options.page_rotate = 0;
+    plugin.options.threads = 1;
+    tz_entries_init(&plugin.list, sizeof(struct tz_list_item));
+    plugin.now.tv_sec = 0;
+    plugin.now.tv_nsec = 0;
+    plugin.travel.pinned = 0;
+    plugin.travel.instant = 0;
+    plugin.travel.offset = 0;
+    plugin.frac = 0;
+    plugin.period = 0;
+    plugin.utf8 = g_get_charset(&charset);
+    plugin.iconv = (plugin.utf8) ? (GIConv) -1
+                                 : g_iconv_open("UTF-8", charset);
+    plugin.hover = NULL;
+    plugin.shm = NULL;
     plugin.vbox = NULL;
+    plugin.atlas = NULL;
+    plugin.worker = NULL;
+    plugin.ring_from = 0;
+    plugin.ring_until = 0;
+    tz_stats_reset(&plugin.stats);
+    tz_clock_parse(getenv(TZ_CLOCK_ENV));
 #if !TOOLTIP_API
     plugin.tooltips = gtk_tooltips_new();
     gtk_tooltips_enable(plugin.tooltips);
@@ -234,7 +408,13 @@ gkrellm_init_plugin(void)
     plugin.monitor = &plugin_mon;
     plugin.expose_event = panel_expose_event;
     plugin.click_event = panel_click_event;
+    plugin.scroll_event = panel_scroll_event;
+    plugin.crossing_event = panel_crossing_event;
     plugin.style_id = gkrellm_add_meter_style(&plugin_mon, CONFIG_KEYWORD);
+#if GKRELLM_CHECK_VERSION(2,2,0)
+    gkrellm_disable_plugin_connect(&plugin_mon, plugin_exit);
+#endif
+    atexit(plugin_exit);
 
     return plugin.monitor;
 }
@@ -0,0 +1,345 @@
+/*
+ * Timezone description and current time.
+ * Copyright (C) 2005--2026 Jiri Denemark
+ *
+ * This file is part of gkrellm-tz.
+ *
+ * gkrellm-tz is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/** @file
+ * Timezone description and current time.
+ * @author Jiri Denemark
+ */
+
+#include <string.h>
+#include <time.h>
+
+#include "item.h"
+#include "civil.h"
+
+
+/** Initialize timezone structure.
+ *
+ * @param item
+ *      timezone structure.
+ *
+ * @return
+ *      nothing.
+ */
+void
+tz_item_init(struct tz_item *item)
+{
+    memset((void *) item, '\0', sizeof(struct tz_item));
+}
+
+
+/** Make time strings prepared for a given time current.
+ *
+ * @param item
+ *      timezone structure.
+ *
+ * @param t
+ *      time.
+ *
+ * @return
+ *      nothing.
+ */
+void
+tz_item_select(struct tz_item *item, time_t t)
+{
+    item->shown = item->ring[tz_item_slot(t)];
+}
+
+
+/** Find local time type of a timezone at a given time without touching
+ * the zone cached in the timezone structure.
+ * Fixed offsets, transitions from the timezone file or TZ rule are used
+ * when available, TZ environment variable is only consulted for timezones
+ * which are none of them. Either way, this may only be called from the
+ * main thread.
+ *
+ * @param item
+ *      timezone structure.
+ *
+ * @param t
+ *      time.
+ *
+ * @param zone
+ *      where to store the result.
+ *
+ * @return
+ *      nothing.
+ */
+void
+tz_item_zone_at(const struct tz_item *item, time_t t, struct tz_zone *zone)
+{
+    if (item->fixed != NULL) {
+        *zone = *item->fixed;
+        return;
+    }
+
+    if (item->tzfile != NULL && tz_tzfile_lookup(item->tzfile, t, zone) == 0)
+        return;
+
+    if (item->rule != NULL)
+        tz_rule_lookup(item->rule, t, zone);
+    else
+        tz_zone_lookup(item->timezone, t, zone);
+}
+
+
+/** Make sure local time type of a timezone is valid at a given time.
+ *
+ * @param item
+ *      timezone structure.
+ *
+ * @param t
+ *      time.
+ *
+ * @return
+ *      nothing.
+ */
+void
+tz_item_zone(struct tz_item *item, time_t t)
+{
+    if (!tz_zone_valid(&item->zone, t))
+        tz_item_zone_at(item, t, &item->zone);
+}
+
+
+/** Format short time string of a given timezone.
+ *
+ * @param item
+ *      timezone structure.
+ *
+ * @param times
+ *      where to store the strings (see tz_item_times and tz_item_slot).
+ *
+ * @param tm
+ *      broken-down local time in the timezone; its timezone related
+ *      fields are filled in from item's zone.
+ *
+ * @param nsec
+ *      nanoseconds of the current second.
+ *
+ * @param render
+ *      renderer of short time strings selected by tz_format_renderer.
+ *
+ * @param format_short
+ *      short time format prepared by tz_format_prepare; only used with
+ *      TZ_RENDER_STRFTIME.
+ *
+ * @return
+ *      nothing.
+ */
+void
+tz_item_format(struct tz_item *item,
+               struct tz_times *times,
+               struct tm *tm,
+               long nsec,
+               enum tz_render render,
+               const char *format_short)
+{
+    times->zone = item->zone;
+
+    tm->tm_isdst = times->zone.isdst;
+    tm->tm_gmtoff = times->zone.gmtoff;
+    tm->tm_zone = times->zone.abbr;
+
+    if (render != TZ_RENDER_STRFTIME) {
+        /* built-in formats contain no fractional seconds */
+        tz_format_render(render, times->time_short, tm);
+        times->frac_count = 0;
+    } else {
+        strftime(times->time_short, TZ_SHORT, format_short, tm);
+        times->frac_count = tz_format_frac_find(times->time_short,
+                                                times->frac);
+        tz_format_frac_set(times->time_short, times->frac,
+                           times->frac_count, nsec);
+    }
+}
+
+
+/** Format long time string of a given timezone for the shown time.
+ *
+ * @param item
+ *      timezone structure.
+ *
+ * @param t
+ *      shown time, the local time type of the shown strings is used.
+ *
+ * @param nsec
+ *      nanoseconds of the current second.
+ *
+ * @param format_long
+ *      long time format prepared by tz_format_prepare.
+ *
+ * @return
+ *      nothing.
+ */
+void
+tz_item_format_long(struct tz_item *item,
+                    time_t t,
+                    long nsec,
+                    const char *format_long)
+{
+    struct tz_frac frac[TZ_FRAC];
+    struct tm tm;
+    int count;
+
+    tz_civil_tm(t, item->shown.zone.gmtoff, &tm);
+    tm.tm_isdst = item->shown.zone.isdst;
+    tm.tm_gmtoff = item->shown.zone.gmtoff;
+    tm.tm_zone = item->shown.zone.abbr;
+
+    strftime(item->time_long, TZ_LONG, format_long, &tm);
+    count = tz_format_frac_find(item->time_long, frac);
+    tz_format_frac_set(item->time_long, frac, count, nsec);
+}
+
+
+/** Find when time strings may change next.
+ *
+ * @param times
+ *      time strings formatted for time t.
+ *
+ * @param t
+ *      time.
+ *
+ * @param period
+ *      how often the strings change as computed by tz_format_period.
+ *
+ * @return
+ *      the first second after t at which the strings may differ, i.e.,
+ *      the next period boundary in local time or the end of local time
+ *      type the strings were formatted with, whichever comes first.
+ */
+time_t
+tz_item_change(const struct tz_times *times, time_t t, int period)
+{
+    time_t next = times->zone.until;
+    time_t boundary;
+    long local;
+
+    if (period > 0) {
+        local = (long) ((t + times->zone.gmtoff) % period);
+        if (local < 0)
+            local += period;
+        boundary = t - local + period;
+        if (boundary < next)
+            next = boundary;
+    }
+
+    return next;
+}
+
+
+/** Format short time strings of timezones into their rings for a range
+ * of seconds. Items not overlapping each other may be converted in
+ * parallel.
+ *
+ * @param items
+ *      timezones with rings.
+ *
+ * @param gmtoff
+ *      offsets of the timezones valid during the whole range.
+ *
+ * @param tm
+ *      space for broken-down time of each timezone.
+ *
+ * @param count
+ *      number of timezones.
+ *
+ * @param from
+ *      the first second of the range.
+ *
+ * @param until
+ *      the first second after the range.
+ *
+ * @param nsec
+ *      nanoseconds for fractional seconds.
+ *
+ * @param render
+ *      renderer selected by tz_format_renderer.
+ *
+ * @param format_short
+ *      short time format prepared by tz_format_prepare.
+ *
+ * @param period
+ *      how often the strings change as computed by tz_format_period.
+ *
+ * @return
+ *      nothing.
+ */
+void
+tz_item_convert(struct tz_item *const *items,
+                const long *gmtoff,
+                struct tm *tm,
+                int count,
+                time_t from,
+                time_t until,
+                long nsec,
+                enum tz_render render,
+                const char *format_short,
+                int period)
+{
+    struct tz_item *item;
+    struct tz_times *times;
+    time_t t;
+    int i;
+
+    for (t = from; t < until; t++) {
+        tz_civil_batch(t, count, gmtoff, tm);
+
+        for (i = 0; i < count; i++) {
+            item = items[i];
+            times = item->ring + tz_item_slot(t);
+
+            /* strings formatted for the previous second are still valid */
+            if (t > from && t < item->next) {
+                *times = item->ring[tz_item_slot(t - 1)];
+                continue;
+            }
+
+            tz_item_format(item, times, tm + i, nsec, render, format_short);
+            item->next = tz_item_change(times, t, period);
+        }
+    }
+}
+
+
+/** Find into how many parts items should be split for conversion by
+ * several threads. Every part has at least TZ_PART_MIN items.
+ *
+ * @param count
+ *      number of items.
+ *
+ * @param threads
+ *      number of threads available.
+ *
+ * @return
+ *      number of parts, 1 means the items should not be split.
+ */
+int
+tz_item_parts(int count, int threads)
+{
+    int parts = count / TZ_PART_MIN;
+
+    if (parts > threads)
+        parts = threads;
+
+    return (parts > 1) ? parts : 1;
+}
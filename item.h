@@ -0,0 +1,164 @@
+/*
+ * Timezone description and current time.
+ * Copyright (C) 2005--2026 Jiri Denemark
+ *
+ * This file is part of gkrellm-tz.
+ *
+ * gkrellm-tz is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/** @file
+ * Timezone description and current time.
+ * @author Jiri Denemark
+ */
+
+#ifndef ITEM_H
+#define ITEM_H
+
+#include <time.h>
+
+#include "options.h"
+#include "zone.h"
+#include "tzfile.h"
+#include "rule.h"
+#include "format.h"
+
+
+/** Number of seconds time strings can be prepared for in advance
+ * (including the current second). Must be a power of two. A new range
+ * is prepared whenever only half of it is left. */
+#define TZ_RING     16
+
+/** Minimum number of items worth converting by a separate thread. */
+#define TZ_PART_MIN 64
+
+
+/** Time strings of a timezone. */
+struct tz_times {
+    /** Local time type the strings were formatted with. */
+    struct tz_zone zone;
+    /** Buffer for short time string. */
+    char time_short[TZ_SHORT];
+    /** Positions of fractional second digits in short time string. */
+    struct tz_frac frac[TZ_FRAC];
+    /** Number of fractional second digits in short time string. */
+    int frac_count;
+};
+
+
+/** Timezone structure. */
+struct tz_item {
+    /** Nonzero if enabled. */
+    int enabled;
+    /** Label to be shown for a given time.
+     * In case it is NULL, timezone field is used as a label. */
+    const char *label;
+    /** Timezone in a form usable for TZ environment variable.
+     * E.g. "US/Central". */
+    const char *timezone;
+    /** Local time type of a timezone with fixed offset (see
+     * tz_zone_fixed), NULL for other timezones. */
+    const struct tz_zone *fixed;
+    /** Transitions of the timezone, NULL if they could not be loaded. */
+    const struct tz_tzfile *tzfile;
+    /** Rule of the timezone if it is a TZ rule string rather than a name
+     * of a timezone file, NULL otherwise. */
+    struct tz_rule *rule;
+    /** Local time type of the timezone. */
+    struct tz_zone zone;
+    /** Current time strings. They are copied from ring so that they stay
+     * valid while the ring is being refilled. */
+    struct tz_times shown;
+    /** Long time string for the shown time, it is only formatted by
+     * tz_item_format_long when it is needed. */
+    char time_long[TZ_LONG];
+    /** Time at which the strings formatted last into ring may change. */
+    time_t next;
+    /** Ring of TZ_RING time strings, element tz_item_slot(t) holds strings
+     * for time t (if they were prepared). Only items being converted have
+     * a ring, it is NULL otherwise. */
+    struct tz_times *ring;
+};
+
+
+/** Get current time strings of a timezone.
+ *
+ * @param item
+ *      pointer to timezone structure.
+ *
+ * @return
+ *      pointer to struct tz_times.
+ */
+#define tz_item_times(item) (&(item)->shown)
+
+/** Get index of ring element holding time strings for a given time.
+ *
+ * @param t
+ *      time.
+ *
+ * @return
+ *      index to ring of struct tz_item.
+ */
+#define tz_item_slot(t)     ((int) ((unsigned long) (t) % TZ_RING))
+
+/** Get index of the first item of a part of items split by
+ * tz_item_parts.
+ *
+ * @param count
+ *      number of items.
+ *
+ * @param parts
+ *      number of parts.
+ *
+ * @param part
+ *      index of the part, parts gives the index after the last item.
+ *
+ * @return
+ *      index of the first item of the part.
+ */
+#define tz_item_part(count, parts, part) \
+    ((int) ((long) (count) * (part) / (parts)))
+
+
+void tz_item_init(struct tz_item *item);
+void tz_item_select(struct tz_item *item, time_t t);
+void tz_item_zone(struct tz_item *item, time_t t);
+void tz_item_zone_at(const struct tz_item *item,
+                     time_t t,
+                     struct tz_zone *zone);
+void tz_item_format(struct tz_item *item,
+                    struct tz_times *times,
+                    struct tm *tm,
+                    long nsec,
+                    enum tz_render render,
+                    const char *format_short);
+void tz_item_format_long(struct tz_item *item,
+                         time_t t,
+                         long nsec,
+                         const char *format_long);
+time_t tz_item_change(const struct tz_times *times, time_t t, int period);
+void tz_item_convert(struct tz_item *const *items,
+                     const long *gmtoff,
+                     struct tm *tm,
+                     int count,
+                     time_t from,
+                     time_t until,
+                     long nsec,
+                     enum tz_render render,
+                     const char *format_short,
+                     int period);
+int tz_item_parts(int count, int threads);
+
+#endif
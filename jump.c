@@ -0,0 +1,175 @@
+/*
+ * Detection of realtime clock steps.
+ * Copyright (C) 2026 Jiri Denemark
+ *
+ * This file is part of gkrellm-tz.
+ *
+ * gkrellm-tz is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+/** @file
+ * Detection of realtime clock steps.
+ * A timer which never expires is armed on a timerfd with
+ * TFD_TIMER_CANCEL_ON_SET, the kernel cancels it whenever the realtime
+ * clock is set (by NTP, date, or when resuming from suspend) and the
+ * descriptor becomes readable in GLib main loop. Without timerfd support
+ * steps are only noticed at the next update.
+ * @author Jiri Denemark
+ */
+
+#include <errno.h>
+#include <limits.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+
+#include <glib.h>
+#include <gtk/gtk.h>
+#include <gkrellm2/gkrellm.h>
+
+#include "features.h"
+#include "jump.h"
+#include "mem.h"
+
+
+#if JUMP_API
+
+/** Clock step detector. */
+struct tz_jump {
+    /** Timer file descriptor. */
+    int fd;
+    /** Channel watching the descriptor. */
+    GIOChannel *channel;
+    /** Source ID of the watch. */
+    guint watch;
+    /** Function called after each step. */
+    void (*callback)(gpointer data);
+    /** Data for the callback. */
+    gpointer data;
+};
+
+
+static int
+tz_jump_arm(int fd)
+{
+    struct itimerspec spec;
+
+    memset(&spec, '\0', sizeof(spec));
+    spec.it_value.tv_sec = (time_t) LONG_MAX;
+
+    return timerfd_settime(fd, TFD_TIMER_ABSTIME | TFD_TIMER_CANCEL_ON_SET,
+                           &spec, NULL);
+}
+
+
+static gboolean
+tz_jump_event(GIOChannel *channel, GIOCondition condition, gpointer data)
+{
+    struct tz_jump *jump = data;
+    uint64_t expirations;
+
+    if (read(jump->fd, &expirations, sizeof(expirations)) >= 0
+        || errno == EAGAIN)
+        return TRUE;
+
+    if (errno != ECANCELED) {
+        jump->watch = 0;
+        return FALSE;
+    }
+
+    /* the timer stays cancelled until it is armed again */
+    tz_jump_arm(jump->fd);
+    jump->callback(jump->data);
+
+    return TRUE;
+}
+
+
+/** Start watching for realtime clock steps.
+ *
+ * @param callback
+ *      function called from the main loop after each step.
+ *
+ * @param data
+ *      data for the callback.
+ *
+ * @return
+ *      step detector or NULL if steps cannot be detected.
+ */
+struct tz_jump *
+tz_jump_new(void (*callback)(gpointer data), gpointer data)
+{
+    struct tz_jump *jump;
+
+    if ((jump = tz_mem_alloc(sizeof(struct tz_jump))) == NULL)
+        return NULL;
+
+    jump->callback = callback;
+    jump->data = data;
+    jump->fd = timerfd_create(CLOCK_REALTIME, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (jump->fd < 0 || tz_jump_arm(jump->fd) < 0) {
+        if (jump->fd >= 0)
+            close(jump->fd);
+        tz_mem_free(jump);
+        return NULL;
+    }
+
+    jump->channel = g_io_channel_unix_new(jump->fd);
+    jump->watch = g_io_add_watch(jump->channel, G_IO_IN,
+                                 tz_jump_event, jump);
+
+    return jump;
+}
+
+
+/** Stop watching for realtime clock steps.
+ *
+ * @param jump
+ *      step detector.
+ *
+ * @return
+ *      nothing.
+ */
+void
+tz_jump_free(struct tz_jump *jump)
+{
+    if (jump == NULL)
+        return;
+
+    if (jump->watch != 0)
+        g_source_remove(jump->watch);
+    g_io_channel_unref(jump->channel);
+    close(jump->fd);
+    tz_mem_free(jump);
+}
+
+#else /* !JUMP_API */
+
+struct tz_jump *
+tz_jump_new(void (*callback)(gpointer data), gpointer data)
+{
+    return NULL;
+}
+
+
+void
+tz_jump_free(struct tz_jump *jump)
+{
+}
+
+#endif /* !JUMP_API */
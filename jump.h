@@ -0,0 +1,38 @@
+/*
+ * Detection of realtime clock steps.
+ * Copyright (C) 2026 Jiri Denemark
+ *
+ * This file is part of gkrellm-tz.
+ *
+ * gkrellm-tz is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+/** @file
+ * Detection of realtime clock steps.
+ * @author Jiri Denemark
+ */
+
+#ifndef JUMP_H
+#define JUMP_H
+
+#include <glib.h>
+
+struct tz_jump;
+
+struct tz_jump *tz_jump_new(void (*callback)(gpointer data), gpointer data);
+void tz_jump_free(struct tz_jump *jump);
+
+#endif
@@ -36,29 +36,27 @@
 
 #include "features.h"
 #include "list.h"
-
-#define LINE    (1 + MAX_TIMEZONE_LENGTH + 1 + MAX_LABEL_LENGTH + 1)
-
-/** Update given timezone structure according to current time.
- * This function sets short and long time strings according to current time
- * in given timezone. It is supposed to be called from a loop once in a
- * second.
+#include "civil.h"
+#include "store.h"
+#include "worker.h"
+#include "clock.h"
+#include "mem.h"
+
+/** Publish current times of all enabled timezones in shared memory.
+ * Timezones on the shown page are published as they are shown, strings of
+ * the others are formatted here.
  *
- * @param t
- *      current time as returned by time().
- *
- * @param item
- *      timezone structure to be updated.
+ * @param plugin
+ *      plugin data.
  *
- * @param options
- *      plugin options.
+ * @param second
+ *      nonzero if a new second started since the last call, otherwise only
+ *      fractional seconds of timezones which are not shown are updated.
  *
  * @return
  *      nothing.
  */
-static void tz_item_update(time_t t,
-                           struct tz_item *item,
-                           struct tz_options *options);
+static void tz_list_publish(struct tz_plugin *plugin, int second);
 
 
 static FILE *
@@ -75,61 +73,34 @@ tz_list_file(const char *mode)
 
     if (filename != NULL)
         file = fopen(filename, mode);
+    g_free(filename);
 
     return file;
 }
 
 
+/** Add a timezone read from the data file to the list.
+ * This is an adapter between tz_store_read and tz_list_add.
+ */
+static int
+tz_list_load_item(void *opaque,
+                  int enabled,
+                  const char *label,
+                  const char *timezone)
+{
+    return tz_list_add((struct tz_plugin *) opaque, enabled, label, timezone);
+}
+
+
 void
 tz_list_load(struct tz_plugin *plugin)
 {
     FILE *file;
-    char line[LINE + 1];
-    char *tz;
-    char *lbl;
-    int enabled;
-    int i;
-    int len;
 
     if ((file = tz_list_file("r")) == NULL)
         return;
 
-    while (fgets(line, LINE, file) != NULL) {
-        len = strlen(line);
-
-        for (i = 0; i < MAX_TIMEZONE_LENGTH && line[i] != ':'; i++)
-            ;
-        line[i] = '\0';
-
-        switch (*line) {
-        case '-':
-            enabled = 0;
-            tz = line + 1;
-            break;
-        case '+':
-            enabled = 1;
-            tz = line + 1;
-            break;
-        default:
-            enabled = 1;
-            tz = line;
-        }
-        lbl = line + i + 1;
-
-        if (line[len - 1] != '\n') {
-            tz_list_add(plugin, enabled, lbl, tz);
-
-            /* ignore rest of the line */
-            while (fgets(line, LINE, file) != NULL) {
-                len = strlen(line);
-                if (line[len - 1] == '\n')
-                    break;
-            }
-        } else {
-            line[len - 1] = '\0';
-            tz_list_add(plugin, enabled, lbl, tz);
-        }
-    }
+    tz_store_read(file, tz_list_load_item, plugin);
 
     fclose(file);
 }
@@ -139,16 +110,11 @@ void
 tz_list_store(struct tz_plugin *plugin)
 {
     FILE *file;
-    struct tz_list_item *item;
 
     if ((file = tz_list_file("w")) == NULL)
         return;
 
-    for (item = plugin->first; item != NULL; item = item->next)
-        fprintf(file, "%c%s:%s\n",
-                (item->tz.enabled) ? '+' : '-',
-                item->tz.timezone,
-                item->tz.label);
+    tz_entries_store(&plugin->list, file);
 
     fclose(file);
 }
@@ -163,25 +129,47 @@ tz_plugin_update(struct tz_plugin *plugin)
     gint wtext;
     gint offset;
     gint h;
+    int glyphs;
+    struct tz_times *times;
+    int i;
 
-    for (item = plugin->first; item != NULL; item = item->next) {
-        if (!item->tz.enabled)
+    if (plugin->options.glyph_cache
+        && plugin->atlas == NULL
+        && plugin->list.first != NULL) {
+        plugin->atlas =
+            tz_atlas_new(gkrellm_meter_alt_textstyle(plugin->style_id));
+    }
+
+    for (i = 0; i < plugin->list.batch.count; i++) {
+        item = tz_list_item_of(plugin->list.batch.items[i]);
+        if (!item->dirty)
             continue;
+        item->dirty = 0;
+        times = tz_item_times(&item->entry.tz);
 
-        if (strchr(item->tz.time_short, '<') != NULL
-            && !pango_parse_markup(item->tz.time_short, -1, 0,
+        glyphs = plugin->options.glyph_cache
+                 && item->layer.decal != NULL
+                 && tz_atlas_usable(plugin->atlas, times->time_short);
+
+        if (!glyphs
+            && strchr(times->time_short, '<') != NULL
+            && !pango_parse_markup(times->time_short, -1, 0,
                                    NULL, NULL, NULL, NULL))
             continue;
 
         offset = 0;
         if (plugin->options.align != TA_LEFT) {
             gkrellm_decal_get_size(item->decal, &wdecl, &hdecl);
-            gkrellm_text_markup_extents(item->decal->text_style.font,
-                                        item->tz.time_short,
-                                        strlen(item->tz.time_short),
-                                        &wtext, &h, NULL,
-                                        &item->decal->y_ink);
-            wtext += item->decal->text_style.effect;
+            if (glyphs) {
+                wtext = tz_atlas_width(plugin->atlas, times->time_short);
+            } else {
+                gkrellm_text_markup_extents(item->decal->text_style.font,
+                                            times->time_short,
+                                            strlen(times->time_short),
+                                            &wtext, &h, NULL,
+                                            &item->decal->y_ink);
+                wtext += item->decal->text_style.effect;
+            }
 
             if (wtext < wdecl) {
                 switch (plugin->options.align) {
@@ -199,63 +187,535 @@ tz_plugin_update(struct tz_plugin *plugin)
             }
         }
 
-        gkrellm_decal_text_set_offset(item->decal, offset, 0);
-        gkrellm_draw_decal_markup(item->panel, item->decal,
-                                  item->tz.time_short);
-        gkrellm_draw_panel_layers(item->panel);
+        if (glyphs) {
+            if (item->pango) {
+                gkrellm_draw_decal_markup(item->panel, item->decal, "");
+                gkrellm_draw_panel_layers(item->panel);
+                item->pango = 0;
+            }
+            if (item->drawn[0] != '\0' && item->drawn_offset == offset) {
+                tz_atlas_update(plugin->atlas, item->panel, item->decal,
+                                &item->layer, offset, times->time_short,
+                                item->drawn);
+            } else {
+                tz_atlas_draw(plugin->atlas, item->panel, item->decal,
+                              &item->layer, offset, times->time_short);
+            }
+            g_strlcpy(item->drawn, times->time_short, TZ_SHORT);
+            item->drawn_offset = offset;
+        } else {
+            if (item->drawn[0] != '\0')
+                tz_atlas_layer_clear(&item->layer);
+            gkrellm_decal_text_set_offset(item->decal, offset, 0);
+            gkrellm_draw_decal_markup(item->panel, item->decal,
+                                      times->time_short);
+            gkrellm_draw_panel_layers(item->panel);
+            item->pango = 1;
+            item->drawn[0] = '\0';
+        }
     }
 }
 
 
+/** Format time strings of a part of the batch for a range of seconds.
+ * Parts not overlapping each other may be converted in parallel.
+ *
+ * @param plugin
+ *      plugin data.
+ *
+ * @param first
+ *      index of the first item of the part.
+ *
+ * @param last
+ *      index of the first item after the part.
+ *
+ * @param from
+ *      the first second of the range.
+ *
+ * @param until
+ *      the first second after the range.
+ *
+ * @param nsec
+ *      nanoseconds for fractional seconds.
+ *
+ * @return
+ *      nothing.
+ */
 void
-tz_list_update(struct tz_plugin *plugin, time_t t)
+tz_list_convert_part(struct tz_plugin *plugin,
+                     int first,
+                     int last,
+                     time_t from,
+                     time_t until,
+                     long nsec)
 {
-    struct tz_list_item *item;
+    struct tz_batch *batch = &plugin->list.batch;
+
+    tz_item_convert(batch->tz + first, batch->gmtoff + first,
+                    batch->tm + first, last - first, from, until, nsec,
+                    plugin->render, plugin->format_short, plugin->period);
+}
 
-    for (item = plugin->first; item != NULL; item = item->next) {
-        if (item->tz.enabled) {
-            gchar *tmp;
-            gchar *tt;
 
-            tz_item_update(t, &item->tz, &plugin->options);
+void
+tz_list_convert(struct tz_plugin *plugin, time_t from, time_t until, long nsec)
+{
+    if (!tz_worker_split(plugin->worker, from, until, nsec)) {
+        tz_list_convert_part(plugin, 0, plugin->list.batch.count,
+                             from, until, nsec);
+    }
+}
 
-            tmp = g_strdup_printf("%s: %s",
-                                  item->tz.label,
-                                  item->tz.time_long);
-            tt = g_locale_to_utf8(tmp, strlen(tmp), NULL, NULL, NULL);
-            g_free(tmp);
+
+/** Set tooltip of an item to its label and long time string.
+ * The text is built in a stack buffer and the tooltip is only touched
+ * when the text differs from the one already set.
+ *
+ * @param plugin
+ *      plugin data.
+ *
+ * @param item
+ *      list item.
+ *
+ * @return
+ *      nothing.
+ */
+static void
+tz_list_tooltip(struct tz_plugin *plugin, struct tz_list_item *item)
+{
+    gchar tt[TZ_TOOLTIP];
+    const char *time_long = item->entry.tz.time_long;
+    gsize len;
+
+    len = g_strlcpy(tt, item->label_utf8, TZ_TOOLTIP - 2);
+    if (len > TZ_TOOLTIP - 3)
+        len = TZ_TOOLTIP - 3;
+    tt[len++] = ':';
+    tt[len++] = ' ';
+
+    if (plugin->utf8) {
+        g_strlcpy(tt + len, time_long, TZ_TOOLTIP - len);
+    } else if (plugin->iconv != (GIConv) -1) {
+        gchar *in = (gchar *) time_long;
+        gsize in_left = strlen(time_long);
+        gchar *out = tt + len;
+        gsize out_left = TZ_TOOLTIP - len - 1;
+
+        g_iconv(plugin->iconv, NULL, NULL, NULL, NULL);
+        g_iconv(plugin->iconv, &in, &in_left, &out, &out_left);
+        *out = '\0';
+    } else {
+        tt[len] = '\0';
+    }
+
+    if (strcmp(tt, item->tooltip) == 0)
+        return;
+    strcpy(item->tooltip, tt);
 
 #if TOOLTIP_API
-            gtk_widget_set_tooltip_text(item->panel->drawing_area, tt);
+    gtk_widget_set_tooltip_text(item->panel->drawing_area, tt);
 #else
-            gtk_tooltips_set_tip(plugin->tooltips,
-                                 item->panel->drawing_area,
-                                 tt, NULL);
+    gtk_tooltips_set_tip(plugin->tooltips,
+                         item->panel->drawing_area,
+                         tt, NULL);
 #endif
-            g_free(tt);
+}
+
+
+/** Format long time string of an item for the shown time and update its
+ * tooltip. Only the item under the pointer needs this every second.
+ *
+ * @param plugin
+ *      plugin data.
+ *
+ * @param item
+ *      list item.
+ *
+ * @return
+ *      nothing.
+ */
+static void
+tz_list_long(struct tz_plugin *plugin, struct tz_list_item *item)
+{
+    tz_item_format_long(&item->entry.tz, plugin->now.tv_sec,
+                        plugin->now.tv_nsec, plugin->format_long);
+    tz_list_tooltip(plugin, item);
+}
+
+
+/** Remember which item is under the pointer and update its tooltip.
+ *
+ * @param plugin
+ *      plugin data.
+ *
+ * @param item
+ *      list item the pointer entered or NULL if it left.
+ *
+ * @return
+ *      nothing.
+ */
+void
+tz_list_hover(struct tz_plugin *plugin, struct tz_list_item *item)
+{
+    plugin->hover = item;
+    if (item != NULL)
+        tz_list_long(plugin, item);
+}
+
+
+/** Forget all time strings prepared in advance.
+ * This has to be called before the list of items or formats change.
+ *
+ * @param plugin
+ *      plugin data.
+ *
+ * @return
+ *      nothing.
+ */
+static void
+tz_list_invalidate(struct tz_plugin *plugin)
+{
+    tz_worker_reset(plugin->worker);
+    plugin->ring_from = 0;
+    plugin->ring_until = 0;
+    plugin->list.batch.pending = 0;
+}
+
+
+/** Prepare time strings for upcoming seconds following the already
+ * prepared ones. The range ends when any of the zones may change or when
+ * the rings are full. Strings are prepared by the worker thread if there
+ * is one, otherwise they are computed immediately.
+ *
+ * @param plugin
+ *      plugin data.
+ *
+ * @param t
+ *      current time.
+ *
+ * @return
+ *      nothing.
+ */
+static void
+tz_list_prepare(struct tz_plugin *plugin, time_t t)
+{
+    struct tz_batch *batch = &plugin->list.batch;
+    time_t from = plugin->ring_until;
+    time_t until = t + TZ_RING;
+    int i;
+
+    tz_batch_zones(batch, from);
+    for (i = 0; i < batch->count; i++) {
+        if (batch->tz[i]->zone.until < until)
+            until = batch->tz[i]->zone.until;
+    }
+
+    if (plugin->worker != NULL) {
+        tz_worker_post(plugin->worker, from, until);
+    } else {
+        tz_list_convert(plugin, from, until, 0);
+        plugin->ring_until = until;
+    }
+}
+
+
+/** Get due time of an item in the heap.
+ *
+ * @param e
+ *      pointer to struct tz_entry of the item.
+ *
+ * @return
+ *      time at which shown strings of the item may change.
+ */
+#define tz_heap_due(e)  (tz_list_item_of(e)->due)
+
+
+/** Add an item to the heap of items ordered by their due time.
+ *
+ * @param batch
+ *      batch of enabled timezones.
+ *
+ * @param item
+ *      item from the batch which is not in the heap.
+ *
+ * @return
+ *      nothing.
+ */
+static void
+tz_heap_push(struct tz_batch *batch, struct tz_list_item *item)
+{
+    struct tz_entry **heap = batch->heap;
+    int i = batch->pending++;
+    int parent;
+
+    while (i > 0) {
+        parent = (i - 1) / 2;
+        if (tz_heap_due(heap[parent]) <= item->due)
+            break;
+        heap[i] = heap[parent];
+        i = parent;
+    }
+    heap[i] = &item->entry;
+}
+
+
+/** Remove the item which is due first from the heap.
+ *
+ * @param batch
+ *      batch of enabled timezones with nonempty heap.
+ *
+ * @return
+ *      the removed item.
+ */
+static struct tz_list_item *
+tz_heap_pop(struct tz_batch *batch)
+{
+    struct tz_entry **heap = batch->heap;
+    struct tz_entry *top = heap[0];
+    struct tz_entry *last = heap[--batch->pending];
+    int n = batch->pending;
+    int i = 0;
+    int child;
+
+    while ((child = 2 * i + 1) < n) {
+        if (child + 1 < n
+            && tz_heap_due(heap[child + 1]) < tz_heap_due(heap[child]))
+            child++;
+        if (tz_heap_due(last) <= tz_heap_due(heap[child]))
+            break;
+        heap[i] = heap[child];
+        i = child;
+    }
+    if (n > 0)
+        heap[i] = last;
+
+    return tz_list_item_of(top);
+}
+
+
+/** Make strings prepared for the current second shown by an item and
+ * find out when they change next.
+ *
+ * @param plugin
+ *      plugin data.
+ *
+ * @param item
+ *      list item.
+ *
+ * @param now
+ *      current time.
+ *
+ * @return
+ *      nothing.
+ */
+static void
+tz_list_show(struct tz_plugin *plugin,
+             struct tz_list_item *item,
+             const struct timespec *now)
+{
+    struct tz_times *times;
+
+    tz_item_select(&item->entry.tz, now->tv_sec);
+    times = tz_item_times(&item->entry.tz);
+    tz_format_frac_set(times->time_short, times->frac, times->frac_count,
+                       now->tv_nsec);
+
+    item->due = tz_item_change(times, now->tv_sec, plugin->period);
+    item->dirty = 1;
+}
+
+
+void
+tz_list_update(struct tz_plugin *plugin, const struct timespec *now)
+{
+    struct tz_batch *batch = &plugin->list.batch;
+    struct tz_list_item *item;
+    time_t t = now->tv_sec;
+    time_t from = 0;
+    time_t until = 0;
+    int idle;
+    int i;
+
+    plugin->now = *now;
+
+    idle = tz_worker_poll(plugin->worker, &from, &until);
+    if (until > from && from == plugin->ring_until)
+        plugin->ring_until = until;
+
+    if (plugin->ring_from <= t && t < plugin->ring_until) {
+        /* only items whose short strings changed are touched */
+        while (batch->pending > 0 && tz_heap_due(batch->heap[0]) <= t) {
+            item = tz_heap_pop(batch);
+            tz_list_show(plugin, item, now);
+            tz_heap_push(batch, item);
         }
+    } else {
+        /* the clock was stepped or the list changed */
+        tz_list_invalidate(plugin);
+        tz_batch_rings(batch);
+        idle = 1;
+
+        plugin->frac = tz_format_prepare(tz_format_short(plugin->options),
+                                         plugin->format_short, TZ_FORMAT);
+        plugin->render = tz_format_renderer(tz_format_short(plugin->options));
+        tz_format_prepare(tz_format_long(plugin->options),
+                          plugin->format_long, TZ_FORMAT);
+
+        /* long strings are formatted when needed (see tz_list_long) */
+        plugin->period = tz_format_period(plugin->format_short);
+
+        tz_batch_zones(batch, t);
+        tz_list_convert(plugin, t, t + 1, now->tv_nsec);
+        for (i = 0; i < batch->count; i++) {
+            item = tz_list_item_of(batch->items[i]);
+            tz_list_show(plugin, item, now);
+            tz_heap_push(batch, item);
+        }
+        plugin->ring_until = t + 1;
     }
+    plugin->ring_from = t;
+
+    if (plugin->hover != NULL)
+        tz_list_long(plugin, plugin->hover);
+
+    if (tz_travel_active(&plugin->travel))
+        return;
+
+    if (plugin->shm != NULL)
+        tz_list_publish(plugin, 1);
+
+    if (idle && batch->count > 0 && plugin->ring_until - t <= TZ_RING / 2)
+        tz_list_prepare(plugin, t);
+}
+
+
+void
+tz_list_frac(struct tz_plugin *plugin, const struct timespec *now)
+{
+    struct tz_batch *batch = &plugin->list.batch;
+    struct tz_times *times;
+    int i;
+
+    plugin->now = *now;
+
+    for (i = 0; i < batch->count; i++) {
+        times = tz_item_times(batch->tz[i]);
+        /* only panels whose digits changed are redrawn */
+        if (times->frac_count > 0
+            && tz_format_frac_set(times->time_short, times->frac,
+                                  times->frac_count, now->tv_nsec))
+            tz_list_item_of(batch->items[i])->dirty = 1;
+    }
+
+    if (plugin->shm != NULL && !tz_travel_active(&plugin->travel))
+        tz_list_publish(plugin, 0);
+}
+
+
+/** Get the time to be shown, i.e., current time adjusted according to
+ * time travel settings.
+ *
+ * @param plugin
+ *      plugin data.
+ *
+ * @param now
+ *      where to store the time.
+ *
+ * @return
+ *      nothing.
+ */
+void
+tz_list_now(struct tz_plugin *plugin, struct timespec *now)
+{
+    tz_clock_now(now);
+
+    if (plugin->travel.pinned) {
+        now->tv_sec = plugin->travel.instant;
+        now->tv_nsec = 0;
+    }
+    now->tv_sec += plugin->travel.offset;
+}
+
+
+/** Change time travel settings and show the resulting time immediately.
+ * Prepared strings are not used while travelling (they are only prepared
+ * for the current time), all zones are converted on every change instead.
+ * Local time types are found in timezone files or TZ rules, so
+ * scrubbing does not touch TZ environment variable except for timezones
+ * which are neither.
+ *
+ * @param plugin
+ *      plugin data.
+ *
+ * @param pinned
+ *      nonzero if time should stop at instant.
+ *
+ * @param instant
+ *      pinned instant.
+ *
+ * @param offset
+ *      offset (in seconds) added to current or pinned time.
+ *
+ * @return
+ *      nothing.
+ */
+void
+tz_list_travel(struct tz_plugin *plugin,
+               int pinned,
+               time_t instant,
+               long offset)
+{
+    struct timespec now;
+
+    plugin->travel.pinned = pinned;
+    plugin->travel.instant = instant;
+    plugin->travel.offset = offset;
+
+    tz_list_now(plugin, &now);
+    tz_list_update(plugin, &now);
+    tz_plugin_update(plugin);
+}
+
+
+/** Forget time strings prepared in advance and show current time
+ * immediately. This is called when the realtime clock was stepped.
+ *
+ * @param plugin
+ *      plugin data.
+ *
+ * @return
+ *      nothing.
+ */
+void
+tz_list_resync(struct tz_plugin *plugin)
+{
+    struct timespec now;
+
+    tz_list_invalidate(plugin);
+    tz_list_now(plugin, &now);
+    tz_list_update(plugin, &now);
+    tz_plugin_update(plugin);
 }
 
 
 void
 tz_list_clean(struct tz_plugin *plugin)
 {
+    struct tz_entry *entry;
     struct tz_list_item *item;
-    struct tz_list_item *p;
 
-    for (item = plugin->first; item != NULL; ) {
-        if (item->tz.enabled)
+    tz_list_invalidate(plugin);
+
+    for (entry = plugin->list.first; entry != NULL; entry = entry->next) {
+        item = tz_list_item_of(entry);
+        if (entry->tz.enabled) {
             gkrellm_panel_destroy(item->panel);
-        free(item->tz.label);
-        free(item->tz.timezone);
-        p = item->next;
-        free(item);
-        item = p;
+            tz_atlas_layer_free(&item->layer);
+        }
     }
 
-    plugin->first = NULL;
-    plugin->last = NULL;
+    tz_entries_clean(&plugin->list);
+    plugin->hover = NULL;
 }
 
 
@@ -265,27 +725,32 @@ tz_list_add(struct tz_plugin *plugin,
             const char *label,
             const char *timezone)
 {
+    struct tz_entry *entry;
     struct tz_list_item *item;
+    const gchar *label_utf8;
+    gchar *utf8;
 
-    if (timezone == NULL || *timezone == '\0')
+    if (timezone == NULL)
         return -1;
 
-    if (label == NULL)
-        label = timezone;
+    utf8 = g_locale_to_utf8((label != NULL) ? label : timezone, -1,
+                            NULL, NULL, NULL);
+    label_utf8 = tz_arena_intern(&plugin->list.arena,
+                                 (utf8 != NULL) ? utf8 : timezone);
+    g_free(utf8);
+    if (label_utf8 == NULL)
+        return -1;
 
-    for (item = plugin->first; item != NULL; item = item->next) {
-        if (strcmp(item->tz.label, label) == 0)
-            return -1;
-    }
+    /* the batch may be reallocated */
+    if (enabled)
+        tz_list_invalidate(plugin);
 
-    item = (struct tz_list_item *) malloc(sizeof(struct tz_list_item));
-    if (item == NULL)
+    if ((entry = tz_entries_add(&plugin->list, enabled,
+                                label, timezone)) == NULL)
         return -1;
 
-    memset((void *) item, '\0', sizeof(struct tz_list_item));
-    item->tz.enabled = enabled;
-    item->tz.label = strdup(label);
-    item->tz.timezone = strdup(timezone);
+    item = tz_list_item_of(entry);
+    item->label_utf8 = label_utf8;
 
     if (enabled) {
         item->panel = gkrellm_panel_new0();
@@ -298,17 +763,21 @@ tz_list_add(struct tz_plugin *plugin,
         g_signal_connect(G_OBJECT(item->panel->drawing_area),
                          "button_press_event",
                          G_CALLBACK(plugin->click_event), NULL);
+        g_signal_connect(G_OBJECT(item->panel->drawing_area),
+                         "scroll_event",
+                         G_CALLBACK(plugin->scroll_event), NULL);
+        gtk_widget_add_events(item->panel->drawing_area,
+                              GDK_ENTER_NOTIFY_MASK | GDK_LEAVE_NOTIFY_MASK);
+        g_signal_connect(G_OBJECT(item->panel->drawing_area),
+                         "enter_notify_event",
+                         G_CALLBACK(plugin->crossing_event), NULL);
+        g_signal_connect(G_OBJECT(item->panel->drawing_area),
+                         "leave_notify_event",
+                         G_CALLBACK(plugin->crossing_event), NULL);
     } else {
         item->panel = NULL;
     }
 
-    item->prev = plugin->last;
-    plugin->last = item;
-    if (item->prev == NULL)
-        plugin->first = item;
-    else
-        item->prev->next = item;
-
     return 0;
 }
 
@@ -325,31 +794,112 @@ tz_panel_create(struct tz_plugin *plugin, struct tz_list_item *item)
     item->panel->textstyle = text_style;
     item->decal = gkrellm_create_decal_text(item->panel, "Yq", text_style,
                                             style, -1, -1, -1);
+    /* decals of a re-created panel were destroyed by GKrellM */
+    tz_atlas_layer_free(&item->layer);
+    tz_atlas_layer_new(&item->layer, item->panel, item->decal);
+    item->pango = 0;
+    item->drawn[0] = '\0';
+    item->tooltip[0] = '\0';
+    item->dirty = 1;
 
     gkrellm_panel_configure(item->panel, NULL, style);
     gkrellm_panel_create(plugin->vbox, plugin->monitor, item->panel);
 }
 
 
+/** Show a page of enabled timezones and hide the others.
+ * Only timezones on the shown page are converted and drawn. Their time
+ * strings are stale until the next tz_list_update.
+ *
+ * @param plugin
+ *      plugin data.
+ *
+ * @param page
+ *      page to be shown, it wraps around in both directions.
+ *
+ * @return
+ *      nothing.
+ */
+void
+tz_list_page(struct tz_plugin *plugin, int page)
+{
+    struct tz_batch *batch = &plugin->list.batch;
+    struct tz_list_item *item;
+    int size = plugin->options.page_size;
+    int pages;
+    int first;
+    int i;
+
+    if (size <= 0 || size >= batch->total) {
+        size = batch->total;
+        pages = 1;
+    } else {
+        pages = (batch->total + size - 1) / size;
+    }
+
+    page %= pages;
+    if (page < 0)
+        page += pages;
+    first = page * size;
+
+    tz_list_invalidate(plugin);
+    plugin->hover = NULL;
+    batch->page = page;
+    batch->count = 0;
+
+    for (i = 0; i < batch->total; i++) {
+        item = tz_list_item_of(batch->all[i]);
+        if (first <= i && i < first + size) {
+            batch->tz[batch->count] = &item->entry.tz;
+            batch->items[batch->count++] = &item->entry;
+            gkrellm_panel_show(item->panel);
+        } else {
+            item->entry.tz.ring = NULL;
+            gkrellm_panel_hide(item->panel);
+        }
+    }
+}
+
+
 static void
-tz_item_update(time_t t,
-               struct tz_item *item,
-               struct tz_options *options)
+tz_list_publish(struct tz_plugin *plugin, int second)
 {
+    struct tz_batch *batch = &plugin->list.batch;
+    struct tz_shm_zone *zones;
+    struct tz_item *tz;
+    struct tz_times *times;
     struct tm tm;
-    char *tz_old;
+    time_t t = plugin->now.tv_sec;
+    int i;
 
-    tz_old = getenv("TZ");
-    setenv("TZ", item->timezone, 1);
-    tzset();
+    if ((zones = tz_shm_begin(plugin->shm, batch->total)) == NULL)
+        return;
+
+    for (i = 0; i < batch->total; i++) {
+        tz = &batch->all[i]->tz;
+        times = tz_item_times(tz);
+
+        /* only timezones on the shown page have rings */
+        if (tz->ring == NULL && second) {
+            tz_item_zone(tz, t);
+            tz_civil_tm(t, tz->zone.gmtoff, &tm);
+            tz_item_format(tz, times, &tm, plugin->now.tv_nsec,
+                           plugin->render, plugin->format_short);
+        } else if (tz->ring == NULL) {
+            tz_format_frac_set(times->time_short, times->frac,
+                               times->frac_count, plugin->now.tv_nsec);
+        }
 
-    localtime_r(&t, &tm);
-    strftime(item->time_short, TZ_SHORT, tz_format_short(*options), &tm);
-    strftime(item->time_long, TZ_LONG, tz_format_long(*options), &tm);
+        tz_item_format_long(tz, plugin->now.tv_sec, plugin->now.tv_nsec,
+                            plugin->format_long);
+        g_strlcpy(zones[i].label, tz->label, TZ_SHM_LABEL);
+        g_strlcpy(zones[i].timezone, tz->timezone, TZ_SHM_TIMEZONE);
+        g_strlcpy(zones[i].abbr, times->zone.abbr, TZ_SHM_ABBR);
+        zones[i].gmtoff = times->zone.gmtoff;
+        zones[i].isdst = times->zone.isdst;
+        g_strlcpy(zones[i].time_short, times->time_short, TZ_SHM_SHORT);
+        g_strlcpy(zones[i].time_long, tz->time_long, TZ_SHM_LONG);
+    }
 
-    if (tz_old != NULL)
-        setenv("TZ", tz_old, 1);
-    else
-        unsetenv("TZ");
-    tzset();
+    tz_shm_commit(plugin->shm, batch->total, &plugin->now);
 }
@@ -29,125 +29,108 @@
 
 #include <time.h>
 
+#include "options.h"
+#include "item.h"
+#include "entry.h"
+#include "atlas.h"
+#include "shm.h"
+#include "worker.h"
+#include "stats.h"
 
-#define MAX_LABEL_LENGTH    60
-#define MAX_TIMEZONE_LENGTH 60
-
-/** Short time format (used for gkrellm panel) -- 24h+s. */
-#define TZ_SHORT_FORMAT_24s "%T %Z"
-/** Short time format (used for gkrellm panel) -- 24h-s. */
-#define TZ_SHORT_FORMAT_24  "%R %Z"
-/** Short time format (used for gkrellm panel) -- 12h+s. */
-#define TZ_SHORT_FORMAT_12s "%r %Z"
-/** Short time format (used for gkrellm panel) -- 12h-s. */
-#define TZ_SHORT_FORMAT_12  "%I:%M %p %Z"
-/** Length of a buffer for short time string. */
-#define TZ_SHORT            255
-
-/** Get short time format according to plugin options.
- *
- * @param options
- *      plugin options itself (the structure, not a pointer to it).
- *
- * @return
- *      short time format.
- */
-#define tz_format_short(options)    \
-    (((options).custom && (options).format_short != NULL)   \
-        ? (options).format_short                            \
-     : ((!(options).twelve_hour && (options).seconds)       \
-        ? TZ_SHORT_FORMAT_24s                               \
-     : ((!(options).twelve_hour && !(options).seconds)      \
-        ? TZ_SHORT_FORMAT_24                                \
-     : (((options).twelve_hour && (options).seconds)        \
-        ? TZ_SHORT_FORMAT_12s                               \
-        : TZ_SHORT_FORMAT_12))))
-
-
-/** Long time format (used for tooltip message). */
-#define TZ_LONG_FORMAT      "%c %Z (%z)"
-/** Length of a buffer for long time string. */
-#define TZ_LONG             100
-
-/** Get long time format according to plugin options.
- *
- * @param options
- *      plugin options itself (the structure, not a pointer to it).
- *
- * @return
- *      long time format.
- */
-#define tz_format_long(options)     \
-    (((options).custom && (options).format_long != NULL)    \
-        ? (options).format_long                             \
-        : TZ_LONG_FORMAT)
-
-
-/** Timezone structure. */
-struct tz_item {
-    /** Nonzero if enabled. */
-    int enabled;
-    /** Label to be shown for a given time.
-     * In case it is NULL, timezone field is used as a label. */
-    char *label;
-    /** Timezone in a form usable for TZ environment variable.
-     * E.g. "US/Central". */
-    char *timezone;
-    /** Buffer for short time string. */
-    char time_short[TZ_SHORT];
-    /** Buffer for long time string. */
-    char time_long[TZ_LONG];
-};
+
+/** Size of a buffer for tooltip text in UTF-8. */
+#define TZ_TOOLTIP  (4 * (MAX_LABEL_LENGTH + TZ_LONG))
 
 
 /** Timezone list item. */
 struct tz_list_item {
-    /** Pointer to the previous item in the list. */
-    struct tz_list_item *prev;
-    /** Pointer to the next item in the list. */
-    struct tz_list_item *next;
+    /** Timezone in the list, it has to be the first member (see
+     * tz_list_item_of). */
+    struct tz_entry entry;
     /** GKrellM panel dedicated for this timezone. */
     GkrellmPanel *panel;
     /** GKrellM decal containing short time string. */
     GkrellmDecal *decal;
-    /** Timezone description and current time. */
-    struct tz_item tz;
+    /** Nonzero if the decal contains text drawn by Pango. */
+    int pango;
+    /** Text drawn from glyphs, empty if the decal has to be redrawn. */
+    char drawn[TZ_SHORT];
+    /** Offset of the text drawn from glyphs. */
+    gint drawn_offset;
+    /** Glyphs drawn over the decal. */
+    struct tz_atlas_layer layer;
+    /** Label converted to UTF-8. */
+    const gchar *label_utf8;
+    /** Tooltip text currently set on the panel. */
+    gchar tooltip[TZ_TOOLTIP];
+    /** Time at which shown strings may change. */
+    time_t due;
+    /** Nonzero if shown strings changed since the panel was drawn. */
+    int dirty;
 };
 
-
-/** Text alignment. */
-enum tz_align {
-    TA_LEFT,
-    TA_CENTER,
-    TA_RIGHT
-};
+/** Get list item of a list entry.
+ *
+ * @param e
+ *      pointer to struct tz_entry of the item.
+ *
+ * @return
+ *      pointer to struct tz_list_item.
+ */
+#define tz_list_item_of(e)  ((struct tz_list_item *) (e))
 
 
-/** Plugin options. */
-struct tz_options {
-    /** 12 hour time instead of 24 hour time. */
-    int twelve_hour;
-    /** Show seconds in krells. */
-    int seconds;
-    /** Use custom formats. */
-    int custom;
-    /** Custom format for time in krells. */
-    char *format_short;
-    /** Custom format for time in tooltips. */
-    char *format_long;
-    /** Alignmet of the text in krells. */
-    enum tz_align align;
+/** Time shown instead of the current time. */
+struct tz_travel {
+    /** Nonzero if time is pinned to instant. */
+    int pinned;
+    /** Pinned instant. */
+    time_t instant;
+    /** Offset (in seconds) added to current or pinned time. */
+    long offset;
 };
 
+/** Check whether shown time differs from the current time.
+ *
+ * @param travel
+ *      pointer to struct tz_travel.
+ *
+ * @return
+ *      nonzero if time travel is active.
+ */
+#define tz_travel_active(travel)    ((travel)->pinned || (travel)->offset != 0)
+
 
 /** Plugin data. */
 struct tz_plugin {
     /** Plugin options. */
     struct tz_options options;
-    /** Pointer to the first item in the list. */
-    struct tz_list_item *first;
-    /** Pointer to the last item in the list. */
-    struct tz_list_item *last;
+    /** Timezones (entries of struct tz_list_item). */
+    struct tz_entries list;
+    /** Time the strings were last updated for. */
+    struct timespec now;
+    /** Time travel settings. */
+    struct tz_travel travel;
+    /** Short time format prepared for strftime. */
+    char format_short[TZ_FORMAT];
+    /** Renderer of short time strings (see tz_format_renderer). */
+    enum tz_render render;
+    /** Long time format prepared for strftime. */
+    char format_long[TZ_FORMAT];
+    /** Nonzero if short time strings contain fractional seconds. */
+    int frac;
+    /** How often time strings change (see tz_format_period). */
+    int period;
+    /** Nonzero if locale encoding is UTF-8. */
+    int utf8;
+    /** Converter from locale encoding to UTF-8, (GIConv) -1 if not
+     * needed or not available. */
+    GIConv iconv;
+    /** Item under the pointer whose tooltip is kept up to date, NULL if
+     * there is none. */
+    struct tz_list_item *hover;
+    /** Shared memory for publishing current times, NULL if disabled. */
+    struct tz_shm *shm;
     /** Plugin's vbox. */
     GtkWidget *vbox;
     /** Plugin's description structure. */
@@ -160,8 +143,27 @@ struct tz_plugin {
     gint (*expose_event)(GtkWidget *widget, GdkEventExpose *ev);
     /** Handler for button_press_event. */
     void (*click_event)(GtkWidget *widget, GdkEventButton *ev, gpointer data);
+    /** Handler for scroll_event. */
+    gboolean (*scroll_event)(GtkWidget *widget,
+                             GdkEventScroll *ev,
+                             gpointer data);
+    /** Handler for enter_notify_event and leave_notify_event. */
+    gboolean (*crossing_event)(GtkWidget *widget,
+                               GdkEventCrossing *ev,
+                               gpointer data);
     /** Pointer to a panel style. */
     gint style_id;
+    /** Glyphs in the current text style, NULL until needed. */
+    struct tz_atlas *atlas;
+    /** Worker preparing time strings for upcoming seconds, NULL if
+     * threads are not supported. */
+    struct tz_worker *worker;
+    /** The first second whose time strings are prepared in item rings. */
+    time_t ring_from;
+    /** The first second after those with prepared time strings. */
+    time_t ring_until;
+    /** How late new seconds are shown. */
+    struct tz_stats stats;
 };
 
 
@@ -176,7 +178,26 @@ int tz_list_add(struct tz_plugin *plugin,
                 int enabled,
                 const char *label,
                 const char *timezone);
-void tz_list_update(struct tz_plugin *plugin, time_t t);
+void tz_list_update(struct tz_plugin *plugin, const struct timespec *now);
+void tz_list_frac(struct tz_plugin *plugin, const struct timespec *now);
+void tz_list_hover(struct tz_plugin *plugin, struct tz_list_item *item);
+void tz_list_page(struct tz_plugin *plugin, int page);
+void tz_list_now(struct tz_plugin *plugin, struct timespec *now);
+void tz_list_travel(struct tz_plugin *plugin,
+                    int pinned,
+                    time_t instant,
+                    long offset);
+void tz_list_resync(struct tz_plugin *plugin);
+void tz_list_convert(struct tz_plugin *plugin,
+                     time_t from,
+                     time_t until,
+                     long nsec);
+void tz_list_convert_part(struct tz_plugin *plugin,
+                          int first,
+                          int last,
+                          time_t from,
+                          time_t until,
+                          long nsec);
 int tz_list_remove();
 int tz_list_move_up();
 int tz_list_move_down();
@@ -0,0 +1,217 @@
+/*
+ * Accounting of memory allocations.
+ * Copyright (C) 2026 Jiri Denemark
+ *
+ * This file is part of gkrellm-tz.
+ *
+ * gkrellm-tz is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+/** @file
+ * Accounting of memory allocations.
+ * @author Jiri Denemark
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "mem.h"
+
+
+/** Header stored in front of every block. */
+union mem_header {
+    /** Size of the block (without the header). */
+    size_t size;
+    /* make the data following the header suitably aligned */
+    long double align_float;
+    void *align_pointer;
+};
+
+
+/** Atomically add to a counter. */
+#define MEM_ADD(counter, value)     __sync_add_and_fetch(&(counter), (value))
+/** Atomically subtract from a counter. */
+#define MEM_SUB(counter, value)     __sync_sub_and_fetch(&(counter), (value))
+
+
+/** Allocation counters. */
+static struct tz_mem mem;
+/** Value of mem.allocs at the beginning of the current tick. */
+static unsigned long mem_tick_start;
+
+
+/** Account for a block of memory.
+ *
+ * @param header
+ *      header of the newly allocated block.
+ *
+ * @param size
+ *      size of the block.
+ *
+ * @return
+ *      pointer to the data of the block.
+ */
+static void *
+tz_mem_add(union mem_header *header, size_t size)
+{
+    size_t live;
+    size_t peak;
+
+    header->size = size;
+    live = MEM_ADD(mem.live, size);
+    MEM_ADD(mem.blocks, 1);
+    MEM_ADD(mem.allocs, 1);
+
+    peak = mem.peak;
+    while (live > peak
+           && !__sync_bool_compare_and_swap(&mem.peak, peak, live))
+        peak = mem.peak;
+
+    return header + 1;
+}
+
+
+/** Allocate memory.
+ *
+ * @param size
+ *      number of bytes.
+ *
+ * @return
+ *      pointer to the memory to be freed by tz_mem_free or NULL on error.
+ */
+void *
+tz_mem_alloc(size_t size)
+{
+    union mem_header *header;
+
+    if ((header = malloc(sizeof(union mem_header) + size)) == NULL)
+        return NULL;
+
+    return tz_mem_add(header, size);
+}
+
+
+/** Change size of allocated memory.
+ *
+ * @param ptr
+ *      memory allocated by tz_mem_alloc or tz_mem_realloc, or NULL.
+ *
+ * @param size
+ *      new number of bytes.
+ *
+ * @return
+ *      pointer to the memory or NULL on error, in which case the original
+ *      memory is left untouched.
+ */
+void *
+tz_mem_realloc(void *ptr, size_t size)
+{
+    union mem_header *header;
+    size_t old;
+
+    if (ptr == NULL)
+        return tz_mem_alloc(size);
+
+    header = (union mem_header *) ptr - 1;
+    old = header->size;
+
+    if ((header = realloc(header, sizeof(union mem_header) + size)) == NULL)
+        return NULL;
+
+    MEM_SUB(mem.live, old);
+    MEM_SUB(mem.blocks, 1);
+    return tz_mem_add(header, size);
+}
+
+
+/** Free memory.
+ *
+ * @param ptr
+ *      memory allocated by tz_mem_alloc, tz_mem_realloc or tz_mem_strdup,
+ *      or NULL.
+ *
+ * @return
+ *      nothing.
+ */
+void
+tz_mem_free(void *ptr)
+{
+    union mem_header *header;
+
+    if (ptr == NULL)
+        return;
+
+    header = (union mem_header *) ptr - 1;
+    MEM_SUB(mem.live, header->size);
+    MEM_SUB(mem.blocks, 1);
+    free(header);
+}
+
+
+/** Duplicate a string.
+ *
+ * @param str
+ *      string or NULL.
+ *
+ * @return
+ *      copy of the string to be freed by tz_mem_free or NULL if str is
+ *      NULL or memory cannot be allocated.
+ */
+char *
+tz_mem_strdup(const char *str)
+{
+    size_t len;
+    char *copy;
+
+    if (str == NULL)
+        return NULL;
+
+    len = strlen(str) + 1;
+    if ((copy = tz_mem_alloc(len)) != NULL)
+        memcpy(copy, str, len);
+
+    return copy;
+}
+
+
+/** Finish a tick (one second of plugin updates) and start a new one.
+ *
+ * @return
+ *      nothing.
+ */
+void
+tz_mem_tick(void)
+{
+    mem.tick = mem.allocs - mem_tick_start;
+    if (mem.tick > mem.tick_max)
+        mem.tick_max = mem.tick;
+    mem_tick_start = mem.allocs;
+}
+
+
+/** Get current allocation counters.
+ *
+ * @param counters
+ *      where to store the counters.
+ *
+ * @return
+ *      nothing.
+ */
+void
+tz_mem_get(struct tz_mem *counters)
+{
+    *counters = mem;
+}
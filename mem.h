@@ -0,0 +1,65 @@
+/*
+ * Accounting of memory allocations.
+ * Copyright (C) 2026 Jiri Denemark
+ *
+ * This file is part of gkrellm-tz.
+ *
+ * gkrellm-tz is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+/** @file
+ * Accounting of memory allocations.
+ * All memory the plugin allocates for itself goes through these wrappers
+ * which keep track of the number of bytes and blocks currently allocated,
+ * so that leaks show up as a growing number rather than a slowly growing
+ * process. Memory allocated by GLib, GTK+ or GKrellM on behalf of the
+ * plugin is not counted. The counters are updated atomically, so memory
+ * may be allocated and freed by any thread; ticks and reading the
+ * counters are left to the main thread.
+ * @author Jiri Denemark
+ */
+
+#ifndef MEM_H
+#define MEM_H
+
+#include <stddef.h>
+
+
+/** Allocation counters. */
+struct tz_mem {
+    /** Bytes currently allocated. */
+    size_t live;
+    /** The most bytes allocated at once. */
+    size_t peak;
+    /** Number of blocks currently allocated. */
+    unsigned long blocks;
+    /** Number of allocations (including reallocations) so far. */
+    unsigned long allocs;
+    /** Number of allocations during the last tick (see tz_mem_tick). */
+    unsigned long tick;
+    /** The most allocations during a single tick. */
+    unsigned long tick_max;
+};
+
+
+void *tz_mem_alloc(size_t size);
+void *tz_mem_realloc(void *ptr, size_t size);
+void tz_mem_free(void *ptr);
+char *tz_mem_strdup(const char *str);
+void tz_mem_tick(void);
+void tz_mem_get(struct tz_mem *counters);
+
+#endif
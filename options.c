@@ -0,0 +1,173 @@
+/*
+ * Plugin options and time formats.
+ * Copyright (C) 2005--2026 Jiri Denemark
+ *
+ * This file is part of gkrellm-tz.
+ *
+ * gkrellm-tz is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/** @file
+ * Plugin options and time formats.
+ * @author Jiri Denemark
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "options.h"
+#include "mem.h"
+
+/** Maximum length of a configuration line. */
+#define OPTIONS_LINE    1024
+
+
+static char *
+strdup_quoted(char *str)
+{
+    int len;
+
+    if (str == NULL)
+        return NULL;
+
+    if (*str == '"')
+        str++;
+
+    len = strlen(str);
+    if (str[len - 1] == '"')
+        str[len - 1] = '\0';
+
+    return tz_mem_strdup(str);
+}
+
+
+/** Parse one line of plugin configuration as stored by GKrellM
+ * (without the leading keyword).
+ *
+ * @param options
+ *      options to be updated.
+ *
+ * @param line
+ *      configuration line, e.g. "options 0 1 0 0".
+ *
+ * @return
+ *      0 if the line was recognized, -1 otherwise.
+ */
+int
+tz_options_load(struct tz_options *options, char *line)
+{
+    char config[32];
+    char value[OPTIONS_LINE];
+
+    if (sscanf(line, "%31s %1023[^\n]", config, value) != 2)
+        return -1;
+
+    if (strcmp(config, "options") == 0) {
+        int twelve_hour;
+        int seconds;
+        int custom;
+        int align;
+        int glyph_cache = 0;
+        int subsecond_hz = 0;
+        int publish = 0;
+        int page_size = 0;
+        int page_rotate = 0;
+        int threads = 1;
+
+        sscanf(value, "%d %d %d %d %d %d %d %d %d %d",
+               &twelve_hour, &seconds, &custom, &align,
+               &glyph_cache, &subsecond_hz, &publish,
+               &page_size, &page_rotate, &threads);
+        options->twelve_hour = twelve_hour != 0;
+        options->seconds = seconds != 0;
+        options->custom = custom != 0;
+        switch (align) {
+        case TA_LEFT:   options->align = TA_LEFT; break;
+        case TA_CENTER: options->align = TA_CENTER; break;
+        case TA_RIGHT:  options->align = TA_RIGHT; break;
+        default:        options->align = TA_LEFT; break;
+        }
+        options->glyph_cache = glyph_cache != 0;
+        options->subsecond_hz = tz_subsecond_hz(subsecond_hz);
+        options->publish = publish != 0;
+        options->page_size = tz_limit(page_size, TZ_PAGE_MAX);
+        options->page_rotate = tz_limit(page_rotate, TZ_ROTATE_MAX);
+        options->threads = tz_threads(threads);
+    } else if (strcmp(config, "format_short") == 0) {
+        if (*value != '\0') {
+            tz_mem_free(options->format_short);
+            options->format_short = strdup_quoted(value);
+        }
+    } else if (strcmp(config, "format_long") == 0) {
+        if (*value != '\0') {
+            tz_mem_free(options->format_long);
+            options->format_long = strdup_quoted(value);
+        }
+    } else {
+        return -1;
+    }
+
+    return 0;
+}
+
+
+/** Replace options with those edited in the config.
+ * Values are limited to the supported ranges and custom formats are copied
+ * only if they are used.
+ *
+ * @param options
+ *      options to be replaced.
+ *
+ * @param edited
+ *      edited options, their formats are ignored.
+ *
+ * @param format_short
+ *      edited custom short time format.
+ *
+ * @param format_long
+ *      edited custom long time format.
+ *
+ * @return
+ *      nothing.
+ */
+void
+tz_options_apply(struct tz_options *options,
+                 const struct tz_options *edited,
+                 const char *format_short,
+                 const char *format_long)
+{
+    tz_mem_free(options->format_short);
+    options->format_short = NULL;
+    tz_mem_free(options->format_long);
+    options->format_long = NULL;
+
+    options->twelve_hour = edited->twelve_hour;
+    options->seconds = edited->seconds;
+    options->custom = edited->custom;
+
+    if (edited->custom) {
+        options->format_short = tz_mem_strdup(format_short);
+        options->format_long = tz_mem_strdup(format_long);
+    }
+
+    options->align = edited->align;
+    options->glyph_cache = edited->glyph_cache;
+    options->subsecond_hz = tz_subsecond_hz(edited->subsecond_hz);
+    options->publish = edited->publish;
+    options->page_size = tz_limit(edited->page_size, TZ_PAGE_MAX);
+    options->page_rotate = tz_limit(edited->page_rotate, TZ_ROTATE_MAX);
+    options->threads = tz_threads(edited->threads);
+}
@@ -0,0 +1,186 @@
+/*
+ * Plugin options and time formats.
+ * Copyright (C) 2005--2026 Jiri Denemark
+ *
+ * This file is part of gkrellm-tz.
+ *
+ * gkrellm-tz is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/** @file
+ * Plugin options and time formats.
+ * @author Jiri Denemark
+ */
+
+#ifndef OPTIONS_H
+#define OPTIONS_H
+
+#define MAX_LABEL_LENGTH    60
+#define MAX_TIMEZONE_LENGTH 60
+
+/** Short time format (used for gkrellm panel) -- 24h+s. */
+#define TZ_SHORT_FORMAT_24s "%T %Z"
+/** Short time format (used for gkrellm panel) -- 24h-s. */
+#define TZ_SHORT_FORMAT_24  "%R %Z"
+/** Short time format (used for gkrellm panel) -- 12h+s. */
+#define TZ_SHORT_FORMAT_12s "%r %Z"
+/** Short time format (used for gkrellm panel) -- 12h-s. */
+#define TZ_SHORT_FORMAT_12  "%I:%M %p %Z"
+/** Length of a buffer for short time string. */
+#define TZ_SHORT            255
+
+/** Get short time format according to plugin options.
+ *
+ * @param options
+ *      plugin options itself (the structure, not a pointer to it).
+ *
+ * @return
+ *      short time format.
+ */
+#define tz_format_short(options)    \
+    (((options).custom && (options).format_short != NULL)   \
+        ? (options).format_short                            \
+     : ((!(options).twelve_hour && (options).seconds)       \
+        ? TZ_SHORT_FORMAT_24s                               \
+     : ((!(options).twelve_hour && !(options).seconds)      \
+        ? TZ_SHORT_FORMAT_24                                \
+     : (((options).twelve_hour && (options).seconds)        \
+        ? TZ_SHORT_FORMAT_12s                               \
+        : TZ_SHORT_FORMAT_12))))
+
+
+/** Long time format (used for tooltip message). */
+#define TZ_LONG_FORMAT      "%c %Z (%z)"
+/** Length of a buffer for long time string. */
+#define TZ_LONG             100
+
+/** Length of a buffer for prepared format string (see tz_format_prepare). */
+#define TZ_FORMAT           (3 * TZ_SHORT)
+
+/** Get long time format according to plugin options.
+ *
+ * @param options
+ *      plugin options itself (the structure, not a pointer to it).
+ *
+ * @return
+ *      long time format.
+ */
+#define tz_format_long(options)     \
+    (((options).custom && (options).format_long != NULL)    \
+        ? (options).format_long                             \
+        : TZ_LONG_FORMAT)
+
+
+/** Minimum rate of redrawing fractional seconds. */
+#define TZ_SUBSECOND_MIN    10
+/** Maximum rate of redrawing fractional seconds. */
+#define TZ_SUBSECOND_MAX    100
+
+/** Limit the rate of redrawing fractional seconds to supported values.
+ *
+ * @param hz
+ *      requested rate, 0 or less means no extra redrawing.
+ *
+ * @return
+ *      0 or the rate within TZ_SUBSECOND_MIN--TZ_SUBSECOND_MAX.
+ */
+#define tz_subsecond_hz(hz)                                 \
+    (((hz) <= 0) ? 0                                        \
+     : ((hz) < TZ_SUBSECOND_MIN) ? TZ_SUBSECOND_MIN         \
+     : ((hz) > TZ_SUBSECOND_MAX) ? TZ_SUBSECOND_MAX         \
+     : (hz))
+
+
+/** Maximum number of timezones shown at once. */
+#define TZ_PAGE_MAX         100
+/** Maximum period (in seconds) of rotating pages. */
+#define TZ_ROTATE_MAX       3600
+/** Maximum number of threads converting time strings. */
+#define TZ_THREADS_MAX      16
+
+/** Limit a value to 0--max.
+ *
+ * @param value
+ *      requested value.
+ *
+ * @param max
+ *      maximum value.
+ *
+ * @return
+ *      value within 0--max.
+ */
+#define tz_limit(value, max)                                \
+    (((value) < 0) ? 0 : ((value) > (max)) ? (max) : (value))
+
+/** Limit number of threads to 1--TZ_THREADS_MAX.
+ *
+ * @param threads
+ *      requested number of threads.
+ *
+ * @return
+ *      number of threads within 1--TZ_THREADS_MAX.
+ */
+#define tz_threads(threads)                                 \
+    (((threads) < 1) ? 1                                    \
+     : ((threads) > TZ_THREADS_MAX) ? TZ_THREADS_MAX        \
+     : (threads))
+
+
+/** Text alignment. */
+enum tz_align {
+    TA_LEFT,
+    TA_CENTER,
+    TA_RIGHT
+};
+
+
+/** Plugin options. */
+struct tz_options {
+    /** 12 hour time instead of 24 hour time. */
+    int twelve_hour;
+    /** Show seconds in krells. */
+    int seconds;
+    /** Use custom formats. */
+    int custom;
+    /** Custom format for time in krells. */
+    char *format_short;
+    /** Custom format for time in tooltips. */
+    char *format_long;
+    /** Alignmet of the text in krells. */
+    enum tz_align align;
+    /** Draw time strings from pre-rendered glyphs when possible. */
+    int glyph_cache;
+    /** How many times a second fractional seconds are redrawn,
+     * 0 means they are redrawn with every GKrellM update. */
+    int subsecond_hz;
+    /** Publish current times in shared memory. */
+    int publish;
+    /** Number of timezones shown at once, 0 means all. */
+    int page_size;
+    /** Period (in seconds) of switching to the next page, 0 disables
+     * automatic switching. */
+    int page_rotate;
+    /** Number of threads converting time strings of long lists. */
+    int threads;
+};
+
+
+int tz_options_load(struct tz_options *options, char *line);
+void tz_options_apply(struct tz_options *options,
+                      const struct tz_options *edited,
+                      const char *format_short,
+                      const char *format_long);
+
+#endif
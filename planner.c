@@ -0,0 +1,433 @@
+/*
+ * Meeting planner.
+ * Copyright (C) 2026 Jiri Denemark
+ *
+ * This file is part of gkrellm-tz.
+ *
+ * gkrellm-tz is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/** @file
+ * Meeting planner.
+ * Local times of all zones in all slots are computed in one pass slot by
+ * slot using batch conversion (see tz_civil_batch) and kept in a grid;
+ * drawing only reads the grid. Shifting the window recomputes the grid,
+ * which takes a binary search per zone and slot at most.
+ * @author Jiri Denemark
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <glib.h>
+#include <gtk/gtk.h>
+#include <gkrellm2/gkrellm.h>
+
+#include "features.h"
+#include "list.h"
+#include "civil.h"
+#include "planner.h"
+#include "mem.h"
+
+/** Length of a slot in seconds. */
+#define PLANNER_SLOT        3600
+/** Number of slots shown by default and in extended mode. */
+#define PLANNER_SLOTS       24
+#define PLANNER_SLOTS_MAX   48
+/** The first and the first non-business hour. */
+#define PLANNER_WORK_START  9
+#define PLANNER_WORK_END    17
+/** Sizes of grid elements in pixels. */
+#define PLANNER_LABEL       130
+#define PLANNER_CELL        24
+#define PLANNER_ROW         20
+/** Size of a buffer for zone label. */
+#define PLANNER_LABEL_LEN   64
+
+/** Cell flags. */
+#define CELL_WORK           0x01
+#define CELL_NIGHT          0x02
+#define CELL_CHANGE         0x04
+#define CELL_HALF           0x08
+
+
+/** Local time of a zone in one slot. */
+struct planner_cell {
+    /** Local hour. */
+    unsigned char hour;
+    /** Combination of CELL_* flags. */
+    unsigned char flags;
+};
+
+
+/** Planner state. */
+struct planner {
+    /** Plugin data. */
+    struct tz_plugin *plugin;
+    /** Popup window, NULL when closed. */
+    GtkWidget *window;
+    /** Drawing area with the grid. */
+    GtkWidget *area;
+    /** The first slot. */
+    time_t start;
+    /** Number of slots. */
+    int slots;
+    /** Number of zones in the grid. */
+    int count;
+    /** Number of zones the arrays can hold. */
+    int size;
+    /** Labels of zones. */
+    gchar (*labels)[PLANNER_LABEL_LEN];
+    /** Local time types of zones. */
+    struct tz_zone *zones;
+    /** Offsets of zones in the current slot. */
+    long *gmtoff;
+    /** Broken-down time of zones in the current slot. */
+    struct tm *tm;
+    /** Grid of count * PLANNER_SLOTS_MAX cells. */
+    struct planner_cell *cells;
+    /** Nonzero for slots in which all zones are in business hours. */
+    unsigned char common[PLANNER_SLOTS_MAX];
+};
+
+
+static struct planner planner;
+
+
+/** Make the arrays big enough for all enabled zones. */
+static int
+planner_resize(int count)
+{
+    void *p;
+
+    if (count <= planner.size)
+        return 0;
+
+    p = tz_mem_realloc(planner.labels, count * sizeof(*planner.labels));
+    if (p == NULL)
+        return -1;
+    planner.labels = p;
+    p = tz_mem_realloc(planner.zones, count * sizeof(*planner.zones));
+    if (p == NULL)
+        return -1;
+    planner.zones = p;
+    p = tz_mem_realloc(planner.gmtoff, count * sizeof(*planner.gmtoff));
+    if (p == NULL)
+        return -1;
+    planner.gmtoff = p;
+    p = tz_mem_realloc(planner.tm, count * sizeof(*planner.tm));
+    if (p == NULL)
+        return -1;
+    planner.tm = p;
+    p = tz_mem_realloc(planner.cells,
+                count * PLANNER_SLOTS_MAX * sizeof(*planner.cells));
+    if (p == NULL)
+        return -1;
+    planner.cells = p;
+    planner.size = count;
+
+    return 0;
+}
+
+
+/** Compute the grid for the current window. */
+static void
+planner_compute(void)
+{
+    struct tz_batch *batch = &planner.plugin->list.batch;
+    struct tz_item *tz;
+    struct planner_cell *cell;
+    struct tm *tm;
+    time_t t;
+    int i;
+    int k;
+
+    planner.count = 0;
+    if (planner_resize(batch->total) < 0)
+        return;
+    planner.count = batch->total;
+
+    for (i = 0; i < planner.count; i++) {
+        g_strlcpy(planner.labels[i], tz_list_item_of(batch->all[i])->label_utf8,
+                  PLANNER_LABEL_LEN);
+        planner.zones[i].from = 0;
+        planner.zones[i].until = 0;
+    }
+
+    for (k = 0; k < planner.slots; k++) {
+        t = planner.start + (time_t) k * PLANNER_SLOT;
+
+        for (i = 0; i < planner.count; i++) {
+            tz = &batch->all[i]->tz;
+            cell = planner.cells + i * PLANNER_SLOTS_MAX + k;
+
+            if (!tz_zone_valid(planner.zones + i, t))
+                tz_item_zone_at(tz, t, planner.zones + i);
+
+            /* offset changed since the previous slot */
+            cell->flags = 0;
+            if (k > 0 && planner.gmtoff[i] != planner.zones[i].gmtoff)
+                cell->flags |= CELL_CHANGE;
+            planner.gmtoff[i] = planner.zones[i].gmtoff;
+        }
+
+        tz_civil_batch(t, planner.count, planner.gmtoff, planner.tm);
+
+        planner.common[k] = planner.count > 0;
+        for (i = 0; i < planner.count; i++) {
+            tm = planner.tm + i;
+            cell = planner.cells + i * PLANNER_SLOTS_MAX + k;
+
+            cell->hour = tm->tm_hour;
+            if (tm->tm_wday >= 1 && tm->tm_wday <= 5
+                && tm->tm_hour >= PLANNER_WORK_START
+                && tm->tm_hour < PLANNER_WORK_END)
+                cell->flags |= CELL_WORK;
+            else
+                planner.common[k] = 0;
+            if (tm->tm_hour < 7 || tm->tm_hour >= 22)
+                cell->flags |= CELL_NIGHT;
+            if (tm->tm_min != 0)
+                cell->flags |= CELL_HALF;
+        }
+    }
+}
+
+
+/** Recompute the grid and redraw the window. */
+static void
+planner_refresh(void)
+{
+    planner_compute();
+
+    gtk_widget_set_size_request(planner.area,
+                                PLANNER_LABEL + planner.slots * PLANNER_CELL,
+                                (planner.count + 1) * PLANNER_ROW);
+    gtk_widget_queue_draw(planner.area);
+}
+
+
+/** Move the window to start at the current hour. */
+static void
+planner_now(void)
+{
+    struct timespec now;
+
+    tz_list_now(planner.plugin, &now);
+    planner.start = now.tv_sec - now.tv_sec % PLANNER_SLOT;
+}
+
+
+static gboolean
+planner_expose(GtkWidget *widget, GdkEventExpose *ev, gpointer data)
+{
+    cairo_t *cr;
+    struct planner_cell *cell;
+    char text[8];
+    double x;
+    double y;
+    int i;
+    int k;
+
+    cr = gdk_cairo_create(widget->window);
+    gdk_cairo_rectangle(cr, &ev->area);
+    cairo_clip(cr);
+
+    cairo_set_source_rgb(cr, 1, 1, 1);
+    cairo_paint(cr);
+    cairo_set_font_size(cr, 11);
+
+    /* header: slots common to all zones */
+    for (k = 0; k < planner.slots; k++) {
+        if (!planner.common[k])
+            continue;
+        cairo_set_source_rgb(cr, 0.2, 0.6, 0.2);
+        cairo_rectangle(cr, PLANNER_LABEL + k * PLANNER_CELL, 0,
+                        PLANNER_CELL, PLANNER_ROW - 2);
+        cairo_fill(cr);
+    }
+
+    for (i = 0; i < planner.count; i++) {
+        y = (i + 1) * PLANNER_ROW;
+
+        cairo_save(cr);
+        cairo_rectangle(cr, 0, y, PLANNER_LABEL - 4, PLANNER_ROW);
+        cairo_clip(cr);
+        cairo_set_source_rgb(cr, 0, 0, 0);
+        cairo_move_to(cr, 2, y + PLANNER_ROW - 6);
+        cairo_show_text(cr, planner.labels[i]);
+        cairo_restore(cr);
+
+        for (k = 0; k < planner.slots; k++) {
+            cell = planner.cells + i * PLANNER_SLOTS_MAX + k;
+            x = PLANNER_LABEL + k * PLANNER_CELL;
+
+            if (cell->flags & CELL_WORK)
+                cairo_set_source_rgb(cr, 0.7, 0.9, 0.7);
+            else if (cell->flags & CELL_NIGHT)
+                cairo_set_source_rgb(cr, 0.75, 0.75, 0.8);
+            else
+                cairo_set_source_rgb(cr, 0.92, 0.92, 0.92);
+            cairo_rectangle(cr, x, y, PLANNER_CELL - 1, PLANNER_ROW - 1);
+            cairo_fill(cr);
+
+            if (cell->flags & CELL_CHANGE) {
+                cairo_set_source_rgb(cr, 0.8, 0, 0);
+                cairo_rectangle(cr, x, y, 2, PLANNER_ROW - 1);
+                cairo_fill(cr);
+            }
+
+            g_snprintf(text, sizeof(text), "%d%s", cell->hour,
+                       (cell->flags & CELL_HALF) ? "+" : "");
+            cairo_set_source_rgb(cr, 0, 0, 0);
+            cairo_move_to(cr, x + 3, y + PLANNER_ROW - 6);
+            cairo_show_text(cr, text);
+        }
+    }
+
+    cairo_destroy(cr);
+
+    return FALSE;
+}
+
+
+static gboolean
+planner_scroll(GtkWidget *widget, GdkEventScroll *ev, gpointer data)
+{
+    if (ev->direction == GDK_SCROLL_UP || ev->direction == GDK_SCROLL_LEFT)
+        planner.start -= PLANNER_SLOT;
+    else
+        planner.start += PLANNER_SLOT;
+
+    planner_refresh();
+
+    return TRUE;
+}
+
+
+static void
+planner_shift(GtkWidget *widget, gpointer data)
+{
+    int delta = GPOINTER_TO_INT(data);
+
+    if (delta == 0)
+        planner_now();
+    else
+        planner.start += (time_t) delta * PLANNER_SLOT;
+
+    planner_refresh();
+}
+
+
+static void
+planner_extend(GtkToggleButton *toggle, gpointer data)
+{
+    planner.slots = (gtk_toggle_button_get_active(toggle))
+                    ? PLANNER_SLOTS_MAX : PLANNER_SLOTS;
+    planner_refresh();
+}
+
+
+static void
+planner_destroy(GtkWidget *widget, gpointer data)
+{
+    planner.window = NULL;
+    planner.area = NULL;
+}
+
+
+/** Add a button shifting the planner window. */
+static void
+planner_button(GtkWidget *box, const char *label, int delta)
+{
+    GtkWidget *button;
+
+    button = gtk_button_new_with_label(label);
+    g_signal_connect(G_OBJECT(button), "clicked",
+                     G_CALLBACK(planner_shift), GINT_TO_POINTER(delta));
+    gtk_box_pack_start(GTK_BOX(box), button, FALSE, FALSE, 0);
+}
+
+
+/** Open the meeting planner or bring it to front and recompute it.
+ *
+ * @param plugin
+ *      plugin data.
+ *
+ * @return
+ *      nothing.
+ */
+void
+tz_planner_show(struct tz_plugin *plugin)
+{
+    GtkWidget *vbox;
+    GtkWidget *hbox;
+    GtkWidget *scrolled;
+    GtkWidget *toggle;
+
+    planner.plugin = plugin;
+
+    if (planner.window != NULL) {
+        planner_refresh();
+        gtk_window_present(GTK_WINDOW(planner.window));
+        return;
+    }
+
+    planner.slots = PLANNER_SLOTS;
+    planner_now();
+
+    planner.window = gtk_window_new(GTK_WINDOW_TOPLEVEL);
+    gtk_window_set_title(GTK_WINDOW(planner.window), "Meeting planner");
+    gtk_window_set_default_size(GTK_WINDOW(planner.window),
+                                PLANNER_LABEL + PLANNER_SLOTS * PLANNER_CELL
+                                + 30, 300);
+    g_signal_connect(G_OBJECT(planner.window), "destroy",
+                     G_CALLBACK(planner_destroy), NULL);
+
+    vbox = gtk_vbox_new(FALSE, 5);
+    gtk_container_set_border_width(GTK_CONTAINER(vbox), 5);
+    gtk_container_add(GTK_CONTAINER(planner.window), vbox);
+
+    hbox = gtk_hbox_new(FALSE, 5);
+    gtk_box_pack_start(GTK_BOX(vbox), hbox, FALSE, FALSE, 0);
+    planner_button(hbox, "<<", -24);
+    planner_button(hbox, "<", -1);
+    planner_button(hbox, "Now", 0);
+    planner_button(hbox, ">", 1);
+    planner_button(hbox, ">>", 24);
+
+    toggle = gtk_check_button_new_with_label("48 hours");
+    g_signal_connect(G_OBJECT(toggle), "toggled",
+                     G_CALLBACK(planner_extend), NULL);
+    gtk_box_pack_start(GTK_BOX(hbox), toggle, FALSE, FALSE, 0);
+
+    scrolled = gtk_scrolled_window_new(NULL, NULL);
+    gtk_scrolled_window_set_policy(GTK_SCROLLED_WINDOW(scrolled),
+            GTK_POLICY_AUTOMATIC, GTK_POLICY_AUTOMATIC);
+    gtk_box_pack_start(GTK_BOX(vbox), scrolled, TRUE, TRUE, 0);
+
+    planner.area = gtk_drawing_area_new();
+    gtk_widget_add_events(planner.area, GDK_SCROLL_MASK);
+    g_signal_connect(G_OBJECT(planner.area), "expose_event",
+                     G_CALLBACK(planner_expose), NULL);
+    g_signal_connect(G_OBJECT(planner.area), "scroll_event",
+                     G_CALLBACK(planner_scroll), NULL);
+    gtk_scrolled_window_add_with_viewport(GTK_SCROLLED_WINDOW(scrolled),
+                                          planner.area);
+
+    planner_refresh();
+    gtk_widget_show_all(planner.window);
+}
@@ -0,0 +1,36 @@
+/*
+ * Meeting planner.
+ * Copyright (C) 2026 Jiri Denemark
+ *
+ * This file is part of gkrellm-tz.
+ *
+ * gkrellm-tz is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/** @file
+ * Meeting planner.
+ * A popup window showing local times of all enabled timezones in a grid
+ * of hourly slots with business hours highlighted.
+ * @author Jiri Denemark
+ */
+
+#ifndef PLANNER_H
+#define PLANNER_H
+
+struct tz_plugin;
+
+void tz_planner_show(struct tz_plugin *plugin);
+
+#endif
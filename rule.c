@@ -0,0 +1,408 @@
+/*
+ * POSIX TZ rules.
+ * Copyright (C) 2026 Jiri Denemark
+ *
+ * This file is part of gkrellm-tz.
+ *
+ * gkrellm-tz is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+/** @file
+ * POSIX TZ rules.
+ * @author Jiri Denemark
+ */
+
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "civil.h"
+#include "rule.h"
+
+/** Seconds per day. */
+#define DAY             86400
+/** Default time of a transition (02:00:00). */
+#define RULE_TIME       7200
+/** Rules used when daylight saving time has no rules (current US rules;
+ * glibc takes them from "posixrules" timezone file instead). */
+#define RULE_DEFAULT    ",M3.2.0,M11.1.0"
+
+/** Days in each month of a non-leap year. */
+static const int rule_month_days[12] = {
+    31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31
+};
+
+
+static int
+rule_leap(long year)
+{
+    return year % 4 == 0 && (year % 100 != 0 || year % 400 == 0);
+}
+
+
+/** Parse a decimal number.
+ *
+ * @param p
+ *      string.
+ *
+ * @param number
+ *      where to store the number.
+ *
+ * @param min
+ *      minimum allowed value.
+ *
+ * @param max
+ *      maximum allowed value.
+ *
+ * @return
+ *      pointer after the number or NULL if there is no valid number.
+ */
+static const char *
+rule_number(const char *p, int *number, int min, int max)
+{
+    int n = 0;
+    int digits;
+
+    for (digits = 0; *p >= '0' && *p <= '9'; p++, digits++) {
+        if (digits == 3)
+            return NULL;
+        n = 10 * n + *p - '0';
+    }
+
+    if (digits == 0 || n < min || n > max)
+        return NULL;
+
+    *number = n;
+    return p;
+}
+
+
+/** Parse a timezone abbreviation, either alphabetic or quoted in <>.
+ *
+ * @return
+ *      pointer after the abbreviation or NULL on error.
+ */
+static const char *
+rule_name(const char *p, char *abbr)
+{
+    const char *start;
+    size_t len;
+
+    if (*p == '<') {
+        for (start = ++p; *p != '>'; p++) {
+            if (!((*p >= 'A' && *p <= 'Z') || (*p >= 'a' && *p <= 'z')
+                  || (*p >= '0' && *p <= '9') || *p == '+' || *p == '-'))
+                return NULL;
+        }
+        len = p++ - start;
+    } else {
+        for (start = p; (*p >= 'A' && *p <= 'Z') || (*p >= 'a' && *p <= 'z');
+             p++)
+            ;
+        len = p - start;
+    }
+
+    if (len < 3 || len >= TZ_ABBR)
+        return NULL;
+
+    memcpy(abbr, start, len);
+    abbr[len] = '\0';
+    return p;
+}
+
+
+/** Parse [+-]hh[:mm[:ss]].
+ *
+ * @param p
+ *      string.
+ *
+ * @param hours
+ *      maximum number of hours.
+ *
+ * @param secs
+ *      where to store the result in seconds.
+ *
+ * @return
+ *      pointer after the time or NULL on error.
+ */
+static const char *
+rule_time(const char *p, int hours, long *secs)
+{
+    int sign = 1;
+    int h;
+    int m = 0;
+    int s = 0;
+
+    if (*p == '+' || *p == '-')
+        sign = (*p++ == '-') ? -1 : 1;
+
+    if ((p = rule_number(p, &h, 0, hours)) == NULL)
+        return NULL;
+    if (*p == ':' && (p = rule_number(p + 1, &m, 0, 59)) == NULL)
+        return NULL;
+    if (*p == ':' && (p = rule_number(p + 1, &s, 0, 59)) == NULL)
+        return NULL;
+
+    *secs = sign * (3600L * h + 60L * m + s);
+    return p;
+}
+
+
+/** Parse date[/time] of a transition.
+ *
+ * @return
+ *      pointer after the date or NULL on error.
+ */
+static const char *
+rule_date(const char *p, struct tz_rule_date *date)
+{
+    if (*p == 'M') {
+        date->kind = 'M';
+        if ((p = rule_number(p + 1, &date->mon, 1, 12)) == NULL
+            || *p != '.'
+            || (p = rule_number(p + 1, &date->week, 1, 5)) == NULL
+            || *p != '.'
+            || (p = rule_number(p + 1, &date->wday, 0, 6)) == NULL)
+            return NULL;
+    } else if (*p == 'J') {
+        date->kind = 'J';
+        if ((p = rule_number(p + 1, &date->yday, 1, 365)) == NULL)
+            return NULL;
+    } else {
+        date->kind = 'D';
+        if ((p = rule_number(p, &date->yday, 0, 365)) == NULL)
+            return NULL;
+    }
+
+    /* times beyond one day are allowed by RFC 8536 */
+    date->time = RULE_TIME;
+    if (*p == '/' && (p = rule_time(p + 1, 167, &date->time)) == NULL)
+        return NULL;
+
+    return p;
+}
+
+
+/** Parse TZ rule string, e.g., "CET-1CEST,M3.5.0,M10.5.0/3".
+ *
+ * @param arena
+ *      arena the result is allocated from.
+ *
+ * @param str
+ *      rule string.
+ *
+ * @return
+ *      parsed rule or NULL if str is not a valid rule string (it may still
+ *      be a name of a timezone file).
+ */
+struct tz_rule *
+tz_rule_parse(struct tz_arena *arena, const char *str)
+{
+    struct tz_rule rule;
+    struct tz_rule *result;
+    char abbr[TZ_ABBR];
+    const char *p = str;
+    long offset;
+    int i;
+
+    if (str == NULL || *str == ':')
+        return NULL;
+
+    memset(&rule, '\0', sizeof(rule));
+
+    /* offsets are positive west of Greenwich */
+    if ((p = rule_name(p, abbr)) == NULL
+        || (p = rule_time(p, 24, &offset)) == NULL)
+        return NULL;
+    rule.std.gmtoff = -offset;
+    rule.std.isdst = 0;
+    rule.std.from = TZ_TIME_MIN;
+    rule.std.until = TZ_TIME_MAX;
+    tz_zone_abbr(&rule.std, abbr);
+
+    if (*p != '\0') {
+        if ((p = rule_name(p, abbr)) == NULL)
+            return NULL;
+
+        rule.dst.gmtoff = rule.std.gmtoff + 3600;
+        if (*p != ',' && *p != '\0') {
+            if ((p = rule_time(p, 24, &offset)) == NULL)
+                return NULL;
+            rule.dst.gmtoff = -offset;
+        }
+        rule.dst.isdst = 1;
+        tz_zone_abbr(&rule.dst, abbr);
+
+        if (*p == '\0')
+            p = RULE_DEFAULT;
+
+        if (*p != ','
+            || (p = rule_date(p + 1, &rule.start)) == NULL
+            || *p != ','
+            || (p = rule_date(p + 1, &rule.end)) == NULL)
+            return NULL;
+        rule.has_dst = 1;
+    }
+
+    if (*p != '\0')
+        return NULL;
+
+    for (i = 0; i < TZ_RULE_CACHE; i++)
+        rule.cache[i].year = LONG_MIN;
+
+    if ((result = tz_arena_alloc(arena, sizeof(rule))) != NULL)
+        memcpy(result, &rule, sizeof(rule));
+
+    return result;
+}
+
+
+/** Compute the instant of a transition in a given year.
+ *
+ * @param date
+ *      date and local time of the transition.
+ *
+ * @param year
+ *      year.
+ *
+ * @param gmtoff
+ *      offset of the local time the transition is specified in.
+ *
+ * @return
+ *      time of the transition.
+ */
+static time_t
+rule_instant(const struct tz_rule_date *date, long year, long gmtoff)
+{
+    int leap = rule_leap(year);
+    long days = tz_civil_days(year, 0, 1);
+    long first;
+    int mday;
+    int last;
+
+    switch (date->kind) {
+    case 'J':
+        days += date->yday - 1 + (leap && date->yday >= 60);
+        break;
+
+    case 'D':
+        days += date->yday;
+        break;
+
+    default:
+        first = tz_civil_days(year, date->mon - 1, 1);
+        /* 1970-01-01 was Thursday */
+        mday = 1 + (date->wday - (int) ((first % 7 + 11) % 7) + 7) % 7
+               + 7 * (date->week - 1);
+        last = rule_month_days[date->mon - 1] + (leap && date->mon == 2);
+        while (mday > last)
+            mday -= 7;
+        days = first + mday - 1;
+    }
+
+    return (time_t) days * DAY + date->time - gmtoff;
+}
+
+
+/** Get transitions of a given year, computing them if they are not
+ * cached.
+ */
+static const struct tz_rule_year *
+rule_year(struct tz_rule *rule, long year)
+{
+    struct tz_rule_year *entry;
+
+    entry = rule->cache + (year % TZ_RULE_CACHE + TZ_RULE_CACHE)
+                          % TZ_RULE_CACHE;
+    if (entry->year != year) {
+        entry->year = year;
+        entry->start = rule_instant(&rule->start, year, rule->std.gmtoff);
+        entry->end = rule_instant(&rule->end, year, rule->dst.gmtoff);
+    }
+
+    return entry;
+}
+
+
+/** Find local time type at a given time.
+ *
+ * @param rule
+ *      parsed rule.
+ *
+ * @param t
+ *      time.
+ *
+ * @param zone
+ *      where to store the result; it is valid until the next transition.
+ *
+ * @return
+ *      nothing.
+ */
+void
+tz_rule_lookup(struct tz_rule *rule, time_t t, struct tz_zone *zone)
+{
+    const struct tz_rule_year *entry;
+    struct {
+        time_t t;
+        int dst;
+    } ev[6], tmp;
+    struct tm tm;
+    long year;
+    int n = 0;
+    int i;
+    int j;
+
+    if (!rule->has_dst) {
+        *zone = rule->std;
+        return;
+    }
+
+    /* transitions of neighbouring years may be needed near new year */
+    tz_civil_tm(t, 0, &tm);
+    year = tm.tm_year + 1900L;
+    for (i = -1; i <= 1; i++) {
+        entry = rule_year(rule, year + i);
+        ev[n].t = entry->end;
+        ev[n++].dst = 0;
+        ev[n].t = entry->start;
+        ev[n++].dst = 1;
+    }
+
+    /* DST lasting the whole year ends and starts again at the same time,
+     * so that ends sort before starts */
+    for (i = 1; i < n; i++) {
+        for (j = i;
+             j > 0 && (ev[j - 1].t > ev[j].t
+                       || (ev[j - 1].t == ev[j].t && ev[j - 1].dst));
+             j--) {
+            tmp = ev[j];
+            ev[j] = ev[j - 1];
+            ev[j - 1] = tmp;
+        }
+    }
+
+    for (i = 0; i < n && ev[i].t <= t; i++)
+        ;
+
+    if (i == 0) {
+        *zone = (ev[0].dst) ? rule->std : rule->dst;
+        zone->from = TZ_TIME_MIN;
+    } else {
+        *zone = (ev[i - 1].dst) ? rule->dst : rule->std;
+        zone->from = ev[i - 1].t;
+    }
+    zone->until = (i < n) ? ev[i].t : t + 1;
+}
@@ -0,0 +1,97 @@
+/*
+ * POSIX TZ rules.
+ * Copyright (C) 2026 Jiri Denemark
+ *
+ * This file is part of gkrellm-tz.
+ *
+ * gkrellm-tz is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+/** @file
+ * POSIX TZ rules.
+ * Timezones described by a rule string (e.g., "EST5EDT,M3.2.0,M11.1.0")
+ * rather than a timezone file, and times after the last transition in
+ * timezone files (whose footer contains such a string), are evaluated
+ * directly without touching TZ environment variable. Transitions are
+ * computed once per year and cached in the rule.
+ * @author Jiri Denemark
+ */
+
+#ifndef RULE_H
+#define RULE_H
+
+#include <time.h>
+
+#include "arena.h"
+#include "zone.h"
+
+/** Number of years whose transitions are cached in a rule. */
+#define TZ_RULE_CACHE   4
+
+
+/** Day and time of a transition within a year. */
+struct tz_rule_date {
+    /** 'J' for Julian day 1--365 without February 29, 'D' for zero based
+     * day 0--365, 'M' for a day of week in a month. */
+    char kind;
+    /** Day of year for 'J' and 'D'. */
+    int yday;
+    /** Month (1--12) for 'M'. */
+    int mon;
+    /** Week (1--5, 5 is the last one) for 'M'. */
+    int week;
+    /** Day of week (0--6, Sunday is 0) for 'M'. */
+    int wday;
+    /** Local time of the transition in seconds after midnight, may be
+     * negative or exceed one day. */
+    long time;
+};
+
+
+/** Transitions in a given year. */
+struct tz_rule_year {
+    /** The year, 0 if the entry is empty. */
+    long year;
+    /** Start of daylight saving time. */
+    time_t start;
+    /** End of daylight saving time. */
+    time_t end;
+};
+
+
+/** Parsed TZ rule string.
+ * Rules are only used from the main thread since lookups update the
+ * cache. */
+struct tz_rule {
+    /** Standard time. */
+    struct tz_zone std;
+    /** Daylight saving time. */
+    struct tz_zone dst;
+    /** Nonzero if the rule has daylight saving time. */
+    int has_dst;
+    /** Start of daylight saving time. */
+    struct tz_rule_date start;
+    /** End of daylight saving time. */
+    struct tz_rule_date end;
+    /** Transitions of recently used years indexed by year % TZ_RULE_CACHE. */
+    struct tz_rule_year cache[TZ_RULE_CACHE];
+};
+
+
+struct tz_rule *tz_rule_parse(struct tz_arena *arena, const char *str);
+void tz_rule_lookup(struct tz_rule *rule, time_t t, struct tz_zone *zone);
+
+#endif
@@ -0,0 +1,302 @@
+/*
+ * Shared memory snapshot of current times.
+ * Copyright (C) 2026 Jiri Denemark
+ *
+ * This file is part of gkrellm-tz.
+ *
+ * gkrellm-tz is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/** @file
+ * Shared memory snapshot of current times.
+ * @author Jiri Denemark
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "shm.h"
+#include "mem.h"
+
+/** Full memory barrier. */
+#define SHM_BARRIER()   __sync_synchronize()
+
+
+/** Initial number of zones the object has room for. */
+#define SHM_CAPACITY    16
+
+
+/** Shared memory object opened by the plugin.
+ * Anything in the mapped header may be modified by other processes, the
+ * plugin keeps its own copies here instead and only reads the sequence
+ * number of an object left behind by a previous run when opening it. */
+struct tz_shm {
+    /** Name of the object. */
+    char name[32];
+    /** File descriptor of the object. */
+    int fd;
+    /** Mapped object. */
+    struct tz_shm_header *header;
+    /** Size of the mapping. */
+    size_t size;
+    /** Number of zones the mapping has room for. */
+    unsigned int capacity;
+    /** Last sequence number written to the header. */
+    uint32_t seq;
+};
+
+
+/** Size of the object able to hold given number of zones.
+ *
+ * @param capacity
+ *      number of zones.
+ *
+ * @return
+ *      size in bytes.
+ */
+static size_t
+tz_shm_size(unsigned int capacity)
+{
+    return sizeof(struct tz_shm_header)
+           + capacity * sizeof(struct tz_shm_zone);
+}
+
+
+/** Resize and remap the object.
+ * The current snapshot is kept and the sequence number is preserved so
+ * that readers notice the change.
+ *
+ * @param shm
+ *      shared memory object.
+ *
+ * @param capacity
+ *      requested number of zones.
+ *
+ * @return
+ *      0 on success, -1 on error.
+ */
+static int
+tz_shm_resize(struct tz_shm *shm, unsigned int capacity)
+{
+    struct tz_shm_header *header;
+    size_t size = tz_shm_size(capacity);
+
+    if (shm->header != NULL) {
+        munmap(shm->header, shm->size);
+        shm->header = NULL;
+        shm->capacity = 0;
+    }
+
+    if (ftruncate(shm->fd, size) < 0)
+        return -1;
+
+    header = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, shm->fd, 0);
+    if (header == MAP_FAILED)
+        return -1;
+
+    shm->header = header;
+    shm->size = size;
+    shm->capacity = capacity;
+
+    header->seq = shm->seq | 1;
+    SHM_BARRIER();
+    header->magic = TZ_SHM_MAGIC;
+    header->version = TZ_SHM_VERSION;
+    header->zone_size = sizeof(struct tz_shm_zone);
+    header->capacity = capacity;
+    header->count = 0;
+    SHM_BARRIER();
+    shm->seq = (shm->seq | 1) + 1;
+    header->seq = shm->seq;
+
+    return 0;
+}
+
+
+/** Open the shared memory object of the current user.
+ * An object left behind by a previous run is reused only if it is owned
+ * by the user and not accessible by anyone else. It is never shrunk and
+ * its sequence number continues so that readers which still have it
+ * mapped notice the new snapshots. The object is locked while it is open;
+ * if another process (e.g., a second GKrellM) holds the lock, it is the
+ * one publishing and the object is left alone.
+ *
+ * @param name
+ *      name of the object or NULL for the one readers look for (see
+ *      TZ_SHM_NAME).
+ *
+ * @return
+ *      shared memory object or NULL on error.
+ */
+struct tz_shm *
+tz_shm_open(const char *name)
+{
+    struct tz_shm *shm;
+    struct tz_shm_header header;
+    struct stat st;
+    unsigned int capacity = SHM_CAPACITY;
+    int owned = 0;
+    int locked = 0;
+
+    shm = (struct tz_shm *) tz_mem_alloc(sizeof(struct tz_shm));
+    if (shm == NULL)
+        return NULL;
+
+    if (name != NULL)
+        snprintf(shm->name, sizeof(shm->name), "%s", name);
+    else
+        snprintf(shm->name, sizeof(shm->name), TZ_SHM_NAME,
+                 (unsigned int) getuid());
+    shm->header = NULL;
+    shm->size = 0;
+    shm->capacity = 0;
+    shm->seq = 0;
+    shm->fd = shm_open(shm->name, O_RDWR | O_CREAT | O_EXCL,
+                       S_IRUSR | S_IWUSR);
+    if (shm->fd < 0 && errno == EEXIST)
+        shm->fd = shm_open(shm->name, O_RDWR, 0);
+
+    if (shm->fd >= 0
+        && fstat(shm->fd, &st) == 0
+        && st.st_uid == getuid()
+        && (st.st_mode & 0777) == (S_IRUSR | S_IWUSR))
+        owned = 1;
+
+    if (owned && flock(shm->fd, LOCK_EX | LOCK_NB) == 0)
+        locked = 1;
+
+    if (locked && (size_t) st.st_size >= sizeof(header)) {
+        while (tz_shm_size(capacity) < (size_t) st.st_size)
+            capacity *= 2;
+        if (pread(shm->fd, &header, sizeof(header), 0) == sizeof(header))
+            shm->seq = header.seq;
+    }
+
+    if (!locked || tz_shm_resize(shm, capacity) < 0) {
+        if (locked)
+            shm_unlink(shm->name);
+        if (shm->fd >= 0)
+            close(shm->fd);
+        shm->fd = -1;
+        tz_shm_close(shm);
+        return NULL;
+    }
+
+    return shm;
+}
+
+
+/** Close the shared memory object and remove it. Readers which still
+ * have it mapped see the snapshot as invalid (header.magic is cleared).
+ * Only objects locked by tz_shm_open get here, so no other process is
+ * publishing in the removed object.
+ *
+ * @param shm
+ *      shared memory object.
+ *
+ * @return
+ *      nothing.
+ */
+void
+tz_shm_close(struct tz_shm *shm)
+{
+    if (shm == NULL)
+        return;
+
+    if (shm->header != NULL) {
+        shm->header->seq = shm->seq | 1;
+        SHM_BARRIER();
+        shm->header->magic = 0;
+        shm->header->count = 0;
+        SHM_BARRIER();
+        shm->header->seq = (shm->seq | 1) + 1;
+        munmap(shm->header, shm->size);
+    }
+    if (shm->fd >= 0) {
+        shm_unlink(shm->name);
+        close(shm->fd);
+    }
+    tz_mem_free(shm);
+}
+
+
+/** Start writing a new snapshot.
+ * Readers will see the snapshot as inconsistent until tz_shm_commit is
+ * called.
+ *
+ * @param shm
+ *      shared memory object.
+ *
+ * @param count
+ *      number of zones to be written.
+ *
+ * @return
+ *      array of count zones to be filled in or NULL on error.
+ */
+struct tz_shm_zone *
+tz_shm_begin(struct tz_shm *shm, unsigned int count)
+{
+    unsigned int capacity;
+
+    if (shm == NULL)
+        return NULL;
+
+    if (shm->header == NULL || count > shm->capacity) {
+        capacity = (shm->capacity > 0) ? shm->capacity : SHM_CAPACITY;
+        while (capacity < count)
+            capacity *= 2;
+        if (tz_shm_resize(shm, capacity) < 0)
+            return NULL;
+    }
+
+    shm->header->seq = ++shm->seq;
+    SHM_BARRIER();
+
+    return (struct tz_shm_zone *) (shm->header + 1);
+}
+
+
+/** Finish writing a snapshot started by tz_shm_begin.
+ *
+ * @param shm
+ *      shared memory object.
+ *
+ * @param count
+ *      number of zones written.
+ *
+ * @param now
+ *      time the snapshot was computed for.
+ *
+ * @return
+ *      nothing.
+ */
+void
+tz_shm_commit(struct tz_shm *shm,
+              unsigned int count,
+              const struct timespec *now)
+{
+    shm->header->count = count;
+    shm->header->sec = now->tv_sec;
+    shm->header->nsec = now->tv_nsec;
+    SHM_BARRIER();
+    shm->header->seq = ++shm->seq;
+}
@@ -0,0 +1,120 @@
+/*
+ * Shared memory snapshot of current times.
+ * Copyright (C) 2026 Jiri Denemark
+ *
+ * This file is part of gkrellm-tz.
+ *
+ * gkrellm-tz is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/** @file
+ * Shared memory snapshot of current times.
+ *
+ * When enabled, the plugin publishes all enabled timezones into POSIX
+ * shared memory object named "/gkrellm-tz-UID" (see TZ_SHM_NAME). The
+ * object starts with struct tz_shm_header followed by header.capacity
+ * elements of header.zone_size bytes each (struct tz_shm_zone), of which
+ * the first header.count are valid.
+ *
+ * The snapshot is protected by a sequence lock. A reader should
+ *   1. read header.seq and retry while it is odd,
+ *   2. copy whatever it needs,
+ *   3. read header.seq again and start over if it changed.
+ * Readers must also check header.magic and header.version and remap the
+ * object when header.capacity grows beyond what they have mapped. The
+ * object is removed and header.magic cleared when publishing stops.
+ *
+ * This header does not depend on GTK or GKrellM and may be used by other
+ * programs.
+ * @author Jiri Denemark
+ */
+
+#ifndef SHM_H
+#define SHM_H
+
+#include <stdint.h>
+#include <time.h>
+
+/** Format of the shared memory object name, the argument is user ID. */
+#define TZ_SHM_NAME         "/gkrellm-tz-%u"
+/** Magic number identifying the object ("gktz"). */
+#define TZ_SHM_MAGIC        0x7a746b67U
+/** Version of the object layout. */
+#define TZ_SHM_VERSION      1
+
+/** Length of label field. */
+#define TZ_SHM_LABEL        64
+/** Length of timezone field. */
+#define TZ_SHM_TIMEZONE     64
+/** Length of abbreviation field. */
+#define TZ_SHM_ABBR         16
+/** Length of short time string field. */
+#define TZ_SHM_SHORT        256
+/** Length of long time string field. */
+#define TZ_SHM_LONG         128
+
+
+/** Header of the shared memory object. */
+struct tz_shm_header {
+    /** TZ_SHM_MAGIC. */
+    uint32_t magic;
+    /** TZ_SHM_VERSION. */
+    uint32_t version;
+    /** Sequence lock, odd while the snapshot is being written. */
+    volatile uint32_t seq;
+    /** Number of valid zones. */
+    uint32_t count;
+    /** Number of zones the object has room for. */
+    uint32_t capacity;
+    /** Size of one zone. */
+    uint32_t zone_size;
+    /** Time (seconds since epoch) the snapshot was computed for. */
+    int64_t sec;
+    /** Nanoseconds part of the time. */
+    int64_t nsec;
+};
+
+
+/** One timezone in the shared memory object.
+ * All strings are NUL-terminated; time strings are UTF-8 encoded only if
+ * the locale of GKrellM is. */
+struct tz_shm_zone {
+    /** Label of the timezone. */
+    char label[TZ_SHM_LABEL];
+    /** Timezone as configured, e.g. "Europe/Prague". */
+    char timezone[TZ_SHM_TIMEZONE];
+    /** Timezone abbreviation, e.g. "CEST". */
+    char abbr[TZ_SHM_ABBR];
+    /** Offset from UTC in seconds, positive east of Greenwich. */
+    int32_t gmtoff;
+    /** Nonzero if daylight saving time is in effect. */
+    int32_t isdst;
+    /** Time as shown in the panel. */
+    char time_short[TZ_SHM_SHORT];
+    /** Time as shown in the tooltip. */
+    char time_long[TZ_SHM_LONG];
+};
+
+
+struct tz_shm;
+
+struct tz_shm *tz_shm_open(const char *name);
+void tz_shm_close(struct tz_shm *shm);
+struct tz_shm_zone *tz_shm_begin(struct tz_shm *shm, unsigned int count);
+void tz_shm_commit(struct tz_shm *shm,
+                   unsigned int count,
+                   const struct timespec *now);
+
+#endif
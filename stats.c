@@ -0,0 +1,278 @@
+/*
+ * Latency statistics.
+ * Copyright (C) 2026 Jiri Denemark
+ *
+ * This file is part of gkrellm-tz.
+ *
+ * gkrellm-tz is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+/** @file
+ * Latency statistics.
+ * @author Jiri Denemark
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "stats.h"
+
+
+/** Find the bucket a value belongs to.
+ *
+ * @param value
+ *      value lower than 2^TZ_HIST_BITS.
+ *
+ * @return
+ *      index of the bucket.
+ */
+static int
+tz_hist_index(unsigned long value)
+{
+    int shift = 0;
+
+    if (value < TZ_HIST_SUB)
+        return value;
+
+    while ((value >> shift) >= 2 * TZ_HIST_SUB)
+        shift++;
+
+    return (shift + 1) * TZ_HIST_SUB + (int) (value >> shift) - TZ_HIST_SUB;
+}
+
+
+/** Find the range of values counted in a bucket.
+ *
+ * @param index
+ *      index of the bucket.
+ *
+ * @param low
+ *      where to store the lowest value in the bucket.
+ *
+ * @param high
+ *      where to store the highest value in the bucket.
+ *
+ * @return
+ *      nothing.
+ */
+static void
+tz_hist_range(int index, unsigned long *low, unsigned long *high)
+{
+    int shift = index / TZ_HIST_SUB - 1;
+    unsigned long sub = index % TZ_HIST_SUB + TZ_HIST_SUB;
+
+    if (index < TZ_HIST_SUB) {
+        *low = *high = index;
+    } else {
+        *low = sub << shift;
+        *high = ((sub + 1) << shift) - 1;
+    }
+}
+
+
+/** Forget all values recorded in a histogram.
+ *
+ * @param hist
+ *      histogram.
+ *
+ * @return
+ *      nothing.
+ */
+void
+tz_hist_reset(struct tz_hist *hist)
+{
+    memset((void *) hist, '\0', sizeof(struct tz_hist));
+}
+
+
+/** Record a value in a histogram.
+ *
+ * @param hist
+ *      histogram.
+ *
+ * @param value
+ *      value in microseconds.
+ *
+ * @return
+ *      nothing.
+ */
+void
+tz_hist_add(struct tz_hist *hist, unsigned long value)
+{
+    if (value >= 1UL << TZ_HIST_BITS)
+        value = (1UL << TZ_HIST_BITS) - 1;
+
+    hist->buckets[tz_hist_index(value)]++;
+    hist->count++;
+    if (value > hist->max)
+        hist->max = value;
+}
+
+
+/** Find a percentile of recorded values.
+ *
+ * @param hist
+ *      histogram.
+ *
+ * @param percent
+ *      percentile (0--100).
+ *
+ * @return
+ *      the highest value equivalent to the percentile (i.e., the upper
+ *      bound of its bucket, but never more than the largest recorded
+ *      value), 0 if the histogram is empty.
+ */
+unsigned long
+tz_hist_percentile(const struct tz_hist *hist, double percent)
+{
+    unsigned long target;
+    unsigned long seen = 0;
+    unsigned long low;
+    unsigned long high;
+    int i;
+
+    if (hist->count == 0)
+        return 0;
+
+    target = (unsigned long) (percent / 100.0 * hist->count + 0.5);
+    if (target < 1)
+        target = 1;
+    if (target > hist->count)
+        target = hist->count;
+
+    for (i = 0; i < TZ_HIST_BUCKETS; i++) {
+        seen += hist->buckets[i];
+        if (seen >= target)
+            break;
+    }
+
+    tz_hist_range(i, &low, &high);
+    return (high < hist->max) ? high : hist->max;
+}
+
+
+/** Forget all recorded latencies.
+ *
+ * @param stats
+ *      statistics.
+ *
+ * @return
+ *      nothing.
+ */
+void
+tz_stats_reset(struct tz_stats *stats)
+{
+    tz_hist_reset(&stats->skew);
+    tz_hist_reset(&stats->paint);
+}
+
+
+/** Record latencies of showing a new second.
+ *
+ * @param stats
+ *      statistics.
+ *
+ * @param tick
+ *      real time at which the new second was noticed.
+ *
+ * @param done
+ *      real time at which drawing of all panels finished.
+ *
+ * @return
+ *      nothing.
+ */
+void
+tz_stats_tick(struct tz_stats *stats,
+              const struct timespec *tick,
+              const struct timespec *done)
+{
+    long long paint;
+
+    paint = (long long) (done->tv_sec - tick->tv_sec) * 1000000
+            + done->tv_nsec / 1000;
+    if (paint < 0)
+        paint = 0;
+
+    tz_hist_add(&stats->skew, tick->tv_nsec / 1000);
+    tz_hist_add(&stats->paint, (unsigned long) paint);
+}
+
+
+/** Write a histogram to a file.
+ *
+ * @param name
+ *      name of the histogram.
+ *
+ * @param hist
+ *      histogram.
+ *
+ * @param file
+ *      where to write.
+ *
+ * @return
+ *      nothing.
+ */
+static void
+tz_hist_write(const char *name, const struct tz_hist *hist, FILE *file)
+{
+    unsigned long low;
+    unsigned long high;
+    int i;
+
+    for (i = 0; i < TZ_HIST_BUCKETS; i++) {
+        if (hist->buckets[i] == 0)
+            continue;
+        tz_hist_range(i, &low, &high);
+        fprintf(file, "%s\t%lu\t%lu\t%lu\n", name, low, high, hist->buckets[i]);
+    }
+}
+
+
+/** Write summary and all nonempty buckets of both histograms to a file.
+ *
+ * @param stats
+ *      statistics.
+ *
+ * @param file
+ *      where to write.
+ *
+ * @return
+ *      0 on success, -1 on error.
+ */
+int
+tz_stats_write(const struct tz_stats *stats, FILE *file)
+{
+    const struct tz_hist *hist[] = { &stats->skew, &stats->paint };
+    const char *name[] = { "skew", "paint" };
+    int i;
+
+    fprintf(file, "# latencies in microseconds after second boundaries\n");
+    fprintf(file, "# name\tcount\tp50\tp99\tmax\n");
+    for (i = 0; i < 2; i++) {
+        fprintf(file, "%s\t%lu\t%lu\t%lu\t%lu\n",
+                name[i], hist[i]->count,
+                tz_hist_percentile(hist[i], 50),
+                tz_hist_percentile(hist[i], 99),
+                hist[i]->max);
+    }
+
+    fprintf(file, "# name\tfrom\tto\tcount\n");
+    for (i = 0; i < 2; i++)
+        tz_hist_write(name[i], hist[i], file);
+
+    return ferror(file) ? -1 : 0;
+}
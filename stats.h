@@ -0,0 +1,80 @@
+/*
+ * Latency statistics.
+ * Copyright (C) 2026 Jiri Denemark
+ *
+ * This file is part of gkrellm-tz.
+ *
+ * gkrellm-tz is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+/** @file
+ * Latency statistics.
+ * Latencies are counted in HDR-style histograms: values are split into
+ * power of two ranges each of which is divided into TZ_HIST_SUB linear
+ * buckets, so every value is recorded with a relative error below
+ * 1 / TZ_HIST_SUB in constant memory and time.
+ * @author Jiri Denemark
+ */
+
+#ifndef STATS_H
+#define STATS_H
+
+#include <stdio.h>
+#include <time.h>
+
+/** Number of bits of precision kept for each value. */
+#define TZ_HIST_SUB_BITS    5
+/** Number of buckets per power of two. */
+#define TZ_HIST_SUB         (1 << TZ_HIST_SUB_BITS)
+/** Values (in microseconds) are clamped below 2^TZ_HIST_BITS. */
+#define TZ_HIST_BITS        31
+/** Number of buckets in a histogram. */
+#define TZ_HIST_BUCKETS     ((TZ_HIST_BITS - TZ_HIST_SUB_BITS + 1) \
+                             * TZ_HIST_SUB)
+
+
+/** Histogram of latencies in microseconds. */
+struct tz_hist {
+    /** Number of recorded values. */
+    unsigned long count;
+    /** The largest recorded value. */
+    unsigned long max;
+    /** Number of values in each bucket. */
+    unsigned long buckets[TZ_HIST_BUCKETS];
+};
+
+
+/** Accuracy of shown times. */
+struct tz_stats {
+    /** Delay between a second boundary and the update for that second. */
+    struct tz_hist skew;
+    /** Delay between a second boundary and the moment all panels showing
+     * the new second are drawn. */
+    struct tz_hist paint;
+};
+
+
+void tz_hist_reset(struct tz_hist *hist);
+void tz_hist_add(struct tz_hist *hist, unsigned long value);
+unsigned long tz_hist_percentile(const struct tz_hist *hist, double percent);
+
+void tz_stats_reset(struct tz_stats *stats);
+void tz_stats_tick(struct tz_stats *stats,
+                   const struct timespec *tick,
+                   const struct timespec *done);
+int tz_stats_write(const struct tz_stats *stats, FILE *file);
+
+#endif
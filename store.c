@@ -0,0 +1,144 @@
+/*
+ * List of timezones stored in a file.
+ * Copyright (C) 2005--2026 Jiri Denemark
+ *
+ * This file is part of gkrellm-tz.
+ *
+ * gkrellm-tz is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/** @file
+ * List of timezones stored in a file.
+ * @author Jiri Denemark
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "options.h"
+#include "store.h"
+
+/** Timezones may contain escaped colons, each taking two characters. */
+#define LINE    (1 + 2 * MAX_TIMEZONE_LENGTH + 1 + MAX_LABEL_LENGTH + 1)
+
+
+/** Read list of timezones from a file.
+ * Each line has the form "[+-]TIMEZONE:LABEL" where '-' marks disabled
+ * timezones and colons in TIMEZONE (e.g., "UTC+05:30") are escaped as
+ * "\\:".
+ *
+ * @param file
+ *      file to read from.
+ *
+ * @param add
+ *      function called for every timezone read from the file.
+ *
+ * @param opaque
+ *      first argument passed to add.
+ *
+ * @return
+ *      nothing.
+ */
+void
+tz_store_read(FILE *file,
+              int (*add)(void *opaque,
+                         int enabled,
+                         const char *label,
+                         const char *timezone),
+              void *opaque)
+{
+    char line[LINE + 1];
+    char *tz;
+    char *lbl;
+    int enabled;
+    int i;
+    int j;
+    int len;
+
+    while (fgets(line, LINE, file) != NULL) {
+        len = strlen(line);
+
+        for (i = 0, j = 0;
+             i < 2 * MAX_TIMEZONE_LENGTH && line[i] != ':';
+             i++) {
+            if (line[i] == '\\' && line[i + 1] == ':')
+                i++;
+            line[j++] = line[i];
+        }
+        lbl = line + i + 1;
+        line[j] = '\0';
+
+        switch (*line) {
+        case '-':
+            enabled = 0;
+            tz = line + 1;
+            break;
+        case '+':
+            enabled = 1;
+            tz = line + 1;
+            break;
+        default:
+            enabled = 1;
+            tz = line;
+        }
+
+        if (line[len - 1] != '\n') {
+            add(opaque, enabled, lbl, tz);
+
+            /* ignore rest of the line */
+            while (fgets(line, LINE, file) != NULL) {
+                len = strlen(line);
+                if (line[len - 1] == '\n')
+                    break;
+            }
+        } else {
+            line[len - 1] = '\0';
+            add(opaque, enabled, lbl, tz);
+        }
+    }
+}
+
+
+/** Write one timezone to a file in the form read by tz_store_read.
+ *
+ * @param file
+ *      file to write to.
+ *
+ * @param enabled
+ *      nonzero if the timezone is enabled.
+ *
+ * @param timezone
+ *      timezone.
+ *
+ * @param label
+ *      label of the timezone.
+ *
+ * @return
+ *      nothing.
+ */
+void
+tz_store_write(FILE *file,
+               int enabled,
+               const char *timezone,
+               const char *label)
+{
+    putc((enabled) ? '+' : '-', file);
+    for (; *timezone != '\0'; timezone++) {
+        if (*timezone == ':')
+            putc('\\', file);
+        putc(*timezone, file);
+    }
+    fprintf(file, ":%s\n", label);
+}
@@ -0,0 +1,43 @@
+/*
+ * List of timezones stored in a file.
+ * Copyright (C) 2005--2026 Jiri Denemark
+ *
+ * This file is part of gkrellm-tz.
+ *
+ * gkrellm-tz is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/** @file
+ * List of timezones stored in a file.
+ * @author Jiri Denemark
+ */
+
+#ifndef STORE_H
+#define STORE_H
+
+#include <stdio.h>
+
+void tz_store_read(FILE *file,
+                   int (*add)(void *opaque,
+                              int enabled,
+                              const char *label,
+                              const char *timezone),
+                   void *opaque);
+void tz_store_write(FILE *file,
+                    int enabled,
+                    const char *timezone,
+                    const char *label);
+
+#endif
@@ -0,0 +1,366 @@
+/*
+ * Reader of compiled timezone files.
+ * Copyright (C) 2026 Jiri Denemark
+ *
+ * This file is part of gkrellm-tz.
+ *
+ * gkrellm-tz is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/** @file
+ * Reader of compiled timezone files.
+ * @author Jiri Denemark
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "tzfile.h"
+#include "mem.h"
+
+/** Directory with timezone files unless TZDIR environment variable is
+ * set. */
+#define TZFILE_DIR      "/usr/share/zoneinfo"
+/** Maximum size of a timezone file. */
+#define TZFILE_MAX      (256 * 1024)
+/** Size of TZif header. */
+#define TZFILE_HEADER   44
+
+
+/** Read big-endian signed 32b number. */
+static long
+tzfile_int32(const unsigned char *p)
+{
+    unsigned long v = ((unsigned long) p[0] << 24) | ((unsigned long) p[1] << 16)
+                      | ((unsigned long) p[2] << 8) | p[3];
+
+    return (v & 0x80000000UL) ? (long) (v - 0x100000000ULL) : (long) v;
+}
+
+
+/** Read big-endian signed 64b number. */
+static long long
+tzfile_int64(const unsigned char *p)
+{
+    unsigned long long v = 0;
+    int i;
+
+    for (i = 0; i < 8; i++)
+        v = (v << 8) | p[i];
+
+    return (long long) v;
+}
+
+
+/** Read the whole timezone file.
+ *
+ * @param timezone
+ *      timezone name (relative to TZDIR) or absolute path, optionally
+ *      prefixed with ':' as allowed in TZ environment variable.
+ *
+ * @param size
+ *      where to store the size of the file.
+ *
+ * @return
+ *      malloced contents of the file or NULL on error.
+ */
+static unsigned char *
+tzfile_read(const char *timezone, size_t *size)
+{
+    const char *dir;
+    char path[1024];
+    unsigned char *data;
+    FILE *file;
+
+    if (*timezone == ':')
+        timezone++;
+
+    if (*timezone == '/') {
+        snprintf(path, sizeof(path), "%s", timezone);
+    } else {
+        if ((dir = getenv("TZDIR")) == NULL || *dir == '\0')
+            dir = TZFILE_DIR;
+        if (strstr(timezone, "..") != NULL)
+            return NULL;
+        snprintf(path, sizeof(path), "%s/%s", dir, timezone);
+    }
+
+    if ((file = fopen(path, "rb")) == NULL)
+        return NULL;
+
+    if ((data = (unsigned char *) tz_mem_alloc(TZFILE_MAX)) != NULL) {
+        *size = fread(data, 1, TZFILE_MAX, file);
+        if (ferror(file) || *size == TZFILE_MAX) {
+            tz_mem_free(data);
+            data = NULL;
+        }
+    }
+
+    fclose(file);
+
+    return data;
+}
+
+
+/** Compute the size of version 1 data block including its header.
+ *
+ * @param data
+ *      pointer to the header.
+ *
+ * @return
+ *      size of the block in bytes.
+ */
+static long
+tzfile_v1_size(const unsigned char *data)
+{
+    return TZFILE_HEADER
+           + tzfile_int32(data + 20)            /* isutcnt */
+           + tzfile_int32(data + 24)            /* isstdcnt */
+           + tzfile_int32(data + 28) * 8        /* leapcnt */
+           + tzfile_int32(data + 32) * 5        /* timecnt */
+           + tzfile_int32(data + 36) * 6        /* typecnt */
+           + tzfile_int32(data + 40);           /* charcnt */
+}
+
+
+/** Parse one data block of a timezone file.
+ *
+ * @param tzfile
+ *      where to store the result, arrays are allocated from arena.
+ *
+ * @param arena
+ *      arena.
+ *
+ * @param data
+ *      pointer to the header of the block.
+ *
+ * @param end
+ *      the first byte after the file.
+ *
+ * @param wide
+ *      nonzero for the version 2+ block with 64b times.
+ *
+ * @return
+ *      pointer to the first byte after the block or NULL on error.
+ */
+static const unsigned char *
+tzfile_parse(struct tz_tzfile *tzfile,
+             struct tz_arena *arena,
+             const unsigned char *data,
+             const unsigned char *end,
+             int wide)
+{
+    const unsigned char *p;
+    const unsigned char *chars;
+    long isutcnt, isstdcnt, leapcnt, timecnt, typecnt, charcnt;
+    int size = (wide) ? 8 : 4;
+    long i;
+
+    if (end - data < TZFILE_HEADER || memcmp(data, "TZif", 4) != 0)
+        return NULL;
+
+    isutcnt = tzfile_int32(data + 20);
+    isstdcnt = tzfile_int32(data + 24);
+    leapcnt = tzfile_int32(data + 28);
+    timecnt = tzfile_int32(data + 32);
+    typecnt = tzfile_int32(data + 36);
+    charcnt = tzfile_int32(data + 40);
+
+    /* leap seconds ("right/" timezones) are not supported */
+    if (isutcnt < 0 || isstdcnt < 0 || leapcnt != 0
+        || timecnt < 0 || timecnt > TZFILE_MAX
+        || typecnt <= 0 || typecnt > 256
+        || charcnt <= 0 || charcnt > TZFILE_MAX)
+        return NULL;
+
+    p = data + TZFILE_HEADER;
+    if (end - p < timecnt * (size + 1) + typecnt * 6 + charcnt
+                  + isstdcnt + isutcnt)
+        return NULL;
+
+    tzfile->count = timecnt;
+    tzfile->type_count = typecnt;
+    tzfile->times = tz_arena_alloc(arena, (timecnt + 1) * sizeof(time_t));
+    tzfile->type = tz_arena_alloc(arena, timecnt + 1);
+    tzfile->types = tz_arena_alloc(arena,
+                                   typecnt * sizeof(struct tz_tzfile_type));
+    if (tzfile->times == NULL || tzfile->type == NULL || tzfile->types == NULL)
+        return NULL;
+
+    for (i = 0; i < timecnt; i++, p += size) {
+        long long v = (wide) ? tzfile_int64(p) : tzfile_int32(p);
+
+        if (v < TZ_TIME_MIN)
+            v = TZ_TIME_MIN;
+        else if (v > TZ_TIME_MAX)
+            v = TZ_TIME_MAX;
+        tzfile->times[i] = (time_t) v;
+        if (i > 0 && tzfile->times[i] < tzfile->times[i - 1])
+            return NULL;
+    }
+
+    for (i = 0; i < timecnt; i++, p++) {
+        if (*p >= typecnt)
+            return NULL;
+        tzfile->type[i] = *p;
+    }
+
+    chars = p + typecnt * 6;
+    for (i = 0; i < typecnt; i++, p += 6) {
+        struct tz_tzfile_type *type = tzfile->types + i;
+        struct tz_zone zone;
+        char abbr[TZ_ABBR];
+
+        if (p[5] >= charcnt)
+            return NULL;
+        type->gmtoff = tzfile_int32(p);
+        type->isdst = p[4] != 0;
+        snprintf(abbr, TZ_ABBR, "%.*s",
+                 (int) (charcnt - p[5]), (const char *) chars + p[5]);
+
+        zone.gmtoff = type->gmtoff;
+        tz_zone_abbr(&zone, abbr);
+        memcpy(type->abbr, zone.abbr, TZ_ABBR);
+    }
+
+    return chars + charcnt + isstdcnt + isutcnt;
+}
+
+
+/** Load a timezone file.
+ *
+ * @param arena
+ *      arena the result is allocated from.
+ *
+ * @param timezone
+ *      timezone in a form usable for TZ environment variable.
+ *
+ * @return
+ *      loaded timezone file or NULL if the timezone does not name a usable
+ *      timezone file.
+ */
+struct tz_tzfile *
+tz_tzfile_load(struct tz_arena *arena, const char *timezone)
+{
+    struct tz_tzfile *tzfile = NULL;
+    unsigned char *data;
+    const unsigned char *p;
+    const unsigned char *end;
+    const unsigned char *nl;
+    char footer[256];
+    size_t size;
+
+    if ((data = tzfile_read(timezone, &size)) == NULL)
+        return NULL;
+    end = data + size;
+
+    if (size < TZFILE_HEADER || memcmp(data, "TZif", 4) != 0
+        || (tzfile = tz_arena_alloc(arena, sizeof(*tzfile))) == NULL)
+        goto error;
+
+    *footer = '\0';
+    if (data[4] < '2') {
+        if (tzfile_parse(tzfile, arena, data, end, 0) == NULL)
+            goto error;
+    } else {
+        /* version 2+ data with 64b times supersede version 1 data */
+        long skip = tzfile_v1_size(data);
+
+        if (skip < TZFILE_HEADER || skip > end - data
+            || (p = tzfile_parse(tzfile, arena, data + skip, end, 1)) == NULL)
+            goto error;
+
+        if (p < end && *p == '\n'
+            && (nl = memchr(p + 1, '\n', end - p - 1)) != NULL
+            && nl - p - 1 < (long) sizeof(footer)) {
+            memcpy(footer, p + 1, nl - p - 1);
+            footer[nl - p - 1] = '\0';
+        }
+    }
+
+    if ((tzfile->footer = tz_arena_intern(arena, footer)) == NULL)
+        goto error;
+    tzfile->rule = tz_rule_parse(arena, footer);
+
+    tz_mem_free(data);
+    return tzfile;
+
+error:
+    tz_mem_free(data);
+    return NULL;
+}
+
+
+/** Find local time type at a given time.
+ *
+ * @param tzfile
+ *      loaded timezone file.
+ *
+ * @param t
+ *      time.
+ *
+ * @param zone
+ *      where to store the result; it is valid until the next transition.
+ *
+ * @return
+ *      0 on success, -1 if t is after the last transition and the
+ *      timezone file relies on TZ string for such times which could not
+ *      be parsed.
+ */
+int
+tz_tzfile_lookup(const struct tz_tzfile *tzfile,
+                 time_t t,
+                 struct tz_zone *zone)
+{
+    const struct tz_tzfile_type *type;
+    int lo = 0;
+    int hi = tzfile->count;
+    int mid;
+
+    /* find the number of transitions not after t */
+    while (lo < hi) {
+        mid = lo + (hi - lo) / 2;
+        if (tzfile->times[mid] <= t)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    if (lo == tzfile->count && *tzfile->footer != '\0') {
+        if (tzfile->rule == NULL)
+            return -1;
+
+        tz_rule_lookup(tzfile->rule, t, zone);
+        if (lo > 0 && zone->from < tzfile->times[lo - 1])
+            zone->from = tzfile->times[lo - 1];
+        return 0;
+    }
+
+    if (lo == 0) {
+        type = tzfile->types;
+        zone->from = TZ_TIME_MIN;
+    } else {
+        type = tzfile->types + tzfile->type[lo - 1];
+        zone->from = tzfile->times[lo - 1];
+    }
+    zone->until = (lo < tzfile->count) ? tzfile->times[lo] : TZ_TIME_MAX;
+
+    zone->gmtoff = type->gmtoff;
+    zone->isdst = type->isdst;
+    memcpy(zone->abbr, type->abbr, TZ_ABBR);
+
+    return 0;
+}
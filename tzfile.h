@@ -0,0 +1,76 @@
+/*
+ * Reader of compiled timezone files.
+ * Copyright (C) 2026 Jiri Denemark
+ *
+ * This file is part of gkrellm-tz.
+ *
+ * gkrellm-tz is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/** @file
+ * Reader of compiled timezone files (TZif, see tzfile(5)).
+ * Transitions of a timezone are loaded once so that local time type at
+ * any instant is found by binary search without touching TZ environment
+ * variable.
+ * @author Jiri Denemark
+ */
+
+#ifndef TZFILE_H
+#define TZFILE_H
+
+#include <time.h>
+
+#include "arena.h"
+#include "zone.h"
+#include "rule.h"
+
+
+/** Local time type from a timezone file. */
+struct tz_tzfile_type {
+    /** Offset from UTC in seconds. */
+    long gmtoff;
+    /** Nonzero if daylight saving time is in effect. */
+    int isdst;
+    /** Abbreviation. */
+    char abbr[TZ_ABBR];
+};
+
+
+/** Contents of a timezone file. */
+struct tz_tzfile {
+    /** Number of transitions. */
+    int count;
+    /** Sorted transition times. */
+    time_t *times;
+    /** Local time type (index to types) starting at each transition. */
+    unsigned char *type;
+    /** Number of local time types. */
+    int type_count;
+    /** Local time types. */
+    struct tz_tzfile_type *types;
+    /** TZ string describing times after the last transition, empty if
+     * there is none. */
+    const char *footer;
+    /** Parsed footer, NULL if it is empty or invalid. */
+    struct tz_rule *rule;
+};
+
+
+struct tz_tzfile *tz_tzfile_load(struct tz_arena *arena, const char *timezone);
+int tz_tzfile_lookup(const struct tz_tzfile *tzfile,
+                     time_t t,
+                     struct tz_zone *zone);
+
+#endif
@@ -0,0 +1,456 @@
+/*
+ * Background computation of time strings.
+ * Copyright (C) 2026 Jiri Denemark
+ *
+ * This file is part of gkrellm-tz.
+ *
+ * gkrellm-tz is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/** @file
+ * Background computation of time strings.
+ * A single worker thread formats time strings for a range of upcoming
+ * seconds into the items' rings (see tz_item_slot) while the main loop
+ * keeps showing strings prepared earlier. The worker only converts and
+ * formats using offsets looked up in advance by the main loop, so it never
+ * touches TZ environment variable. The main loop must not modify the list,
+ * the batch, zones or prepared formats while tz_worker_poll reports the
+ * worker is busy. With more threads configured, long batches are split
+ * into parts converted in parallel by a pool of threads.
+ * @author Jiri Denemark
+ */
+
+#include <stdlib.h>
+#include <time.h>
+
+#include <glib.h>
+#include <gtk/gtk.h>
+#include <gkrellm2/gkrellm.h>
+
+#include "features.h"
+#include "list.h"
+#include "worker.h"
+#include "mem.h"
+
+#if WORKER_API
+
+/** Background worker. */
+struct tz_worker {
+    /** Plugin data. */
+    struct tz_plugin *plugin;
+    /** Worker thread. */
+    GThread *thread;
+    /** Lock protecting the rest of this structure. */
+    GMutex lock;
+    /** Signalled when a job is posted or finished. */
+    GCond cond;
+    /** Nonzero while a job is pending or running. */
+    int busy;
+    /** The first second to compute strings for. */
+    time_t from;
+    /** The first second after the range to compute strings for. */
+    time_t until;
+    /** Nonzero if strings for the range are ready. */
+    int done;
+    /** Nonzero if the worker thread should exit. */
+    int quit;
+    /** Pool of threads converting parts of the batch or NULL. */
+    GThreadPool *pool;
+    /** Number of threads converting the batch, including the one which
+     * splits it. */
+    int threads;
+    /** Lock protecting parts. */
+    GMutex part_lock;
+    /** Signalled when all parts are converted. */
+    GCond part_cond;
+    /** Number of parts not converted yet. */
+    int parts;
+};
+
+
+/** Part of the batch converted by a thread from the pool. */
+struct tz_worker_part {
+    /** The first item of the part. */
+    int first;
+    /** The first item after the part. */
+    int last;
+    /** The first second to compute strings for. */
+    time_t from;
+    /** The first second after the range to compute strings for. */
+    time_t until;
+    /** Nanoseconds for fractional seconds. */
+    long nsec;
+};
+
+
+static gpointer
+tz_worker_main(gpointer data)
+{
+    struct tz_worker *worker = data;
+    time_t from;
+    time_t until;
+
+    g_mutex_lock(&worker->lock);
+    for (;;) {
+        while (!worker->busy && !worker->quit)
+            g_cond_wait(&worker->cond, &worker->lock);
+        if (worker->quit)
+            break;
+        from = worker->from;
+        until = worker->until;
+        g_mutex_unlock(&worker->lock);
+
+        tz_list_convert(worker->plugin, from, until, 0);
+
+        g_mutex_lock(&worker->lock);
+        worker->done = 1;
+        worker->busy = 0;
+        g_cond_broadcast(&worker->cond);
+    }
+    g_mutex_unlock(&worker->lock);
+
+    return NULL;
+}
+
+
+static void
+tz_worker_part_main(gpointer data, gpointer user_data)
+{
+    struct tz_worker_part *part = data;
+    struct tz_worker *worker = user_data;
+
+    tz_list_convert_part(worker->plugin, part->first, part->last,
+                         part->from, part->until, part->nsec);
+
+    g_mutex_lock(&worker->part_lock);
+    if (--worker->parts == 0)
+        g_cond_signal(&worker->part_cond);
+    g_mutex_unlock(&worker->part_lock);
+}
+
+
+struct tz_worker *
+tz_worker_new(struct tz_plugin *plugin)
+{
+    struct tz_worker *worker;
+
+    worker = (struct tz_worker *) tz_mem_alloc(sizeof(struct tz_worker));
+    if (worker == NULL)
+        return NULL;
+
+    worker->plugin = plugin;
+    worker->busy = 0;
+    worker->from = 0;
+    worker->until = 0;
+    worker->done = 0;
+    worker->quit = 0;
+    worker->pool = NULL;
+    worker->threads = 1;
+    worker->parts = 0;
+    g_mutex_init(&worker->lock);
+    g_cond_init(&worker->cond);
+    g_mutex_init(&worker->part_lock);
+    g_cond_init(&worker->part_cond);
+
+    worker->thread = g_thread_try_new("gkrellm-tz", tz_worker_main,
+                                      worker, NULL);
+    if (worker->thread == NULL) {
+        g_cond_clear(&worker->part_cond);
+        g_mutex_clear(&worker->part_lock);
+        g_cond_clear(&worker->cond);
+        g_mutex_clear(&worker->lock);
+        tz_mem_free(worker);
+        return NULL;
+    }
+
+    return worker;
+}
+
+
+/** Stop the worker, wait for its threads to exit, and free it.
+ *
+ * @param worker
+ *      background worker or NULL.
+ *
+ * @return
+ *      nothing.
+ */
+void
+tz_worker_free(struct tz_worker *worker)
+{
+    if (worker == NULL)
+        return;
+
+    tz_worker_threads(worker, 1);
+
+    g_mutex_lock(&worker->lock);
+    worker->quit = 1;
+    g_cond_broadcast(&worker->cond);
+    g_mutex_unlock(&worker->lock);
+    g_thread_join(worker->thread);
+
+    g_cond_clear(&worker->part_cond);
+    g_mutex_clear(&worker->part_lock);
+    g_cond_clear(&worker->cond);
+    g_mutex_clear(&worker->lock);
+    tz_mem_free(worker);
+}
+
+
+/** Check whether the worker is idle and collect its result.
+ *
+ * @param worker
+ *      background worker or NULL.
+ *
+ * @param from
+ *      where to store the first second of the range the worker prepared
+ *      strings for since the last call.
+ *
+ * @param until
+ *      where to store the first second after the range. Both from and
+ *      until are left untouched if there is no new result.
+ *
+ * @return
+ *      nonzero if the worker is idle, zero if it is still working.
+ */
+int
+tz_worker_poll(struct tz_worker *worker, time_t *from, time_t *until)
+{
+    int idle;
+
+    if (worker == NULL)
+        return 1;
+
+    g_mutex_lock(&worker->lock);
+    idle = !worker->busy;
+    if (idle && worker->done) {
+        *from = worker->from;
+        *until = worker->until;
+        worker->done = 0;
+    }
+    g_mutex_unlock(&worker->lock);
+
+    return idle;
+}
+
+
+/** Wait for the worker to finish its job and forget its result.
+ * This has to be called before the list of items changes.
+ *
+ * @param worker
+ *      background worker or NULL.
+ *
+ * @return
+ *      nothing.
+ */
+void
+tz_worker_reset(struct tz_worker *worker)
+{
+    if (worker == NULL)
+        return;
+
+    g_mutex_lock(&worker->lock);
+    while (worker->busy)
+        g_cond_wait(&worker->cond, &worker->lock);
+    worker->done = 0;
+    g_mutex_unlock(&worker->lock);
+}
+
+
+/** Ask the worker to prepare time strings for a range of seconds.
+ * Zones of all items have to be valid during the whole range and the
+ * range must not contain any second whose strings may be shown until
+ * the worker finishes.
+ *
+ * @param worker
+ *      background worker or NULL.
+ *
+ * @param from
+ *      the first second of the range.
+ *
+ * @param until
+ *      the first second after the range.
+ *
+ * @return
+ *      nothing.
+ */
+void
+tz_worker_post(struct tz_worker *worker, time_t from, time_t until)
+{
+    if (worker == NULL)
+        return;
+
+    g_mutex_lock(&worker->lock);
+    worker->from = from;
+    worker->until = until;
+    worker->done = 0;
+    worker->busy = 1;
+    g_cond_broadcast(&worker->cond);
+    g_mutex_unlock(&worker->lock);
+}
+
+
+/** Set the number of threads converting time strings.
+ *
+ * @param worker
+ *      background worker or NULL.
+ *
+ * @param threads
+ *      number of threads, 1 means the batch is never split.
+ *
+ * @return
+ *      nothing.
+ */
+void
+tz_worker_threads(struct tz_worker *worker, int threads)
+{
+    if (worker == NULL)
+        return;
+
+    tz_worker_reset(worker);
+
+    if (threads <= 1) {
+        if (worker->pool != NULL)
+            g_thread_pool_free(worker->pool, FALSE, TRUE);
+        worker->pool = NULL;
+    } else if (worker->pool == NULL) {
+        worker->pool = g_thread_pool_new(tz_worker_part_main, worker,
+                                         threads - 1, TRUE, NULL);
+    } else {
+        g_thread_pool_set_max_threads(worker->pool, threads - 1, NULL);
+    }
+
+    worker->threads = (worker->pool != NULL) ? threads : 1;
+}
+
+
+/** Convert the batch in parallel if it is long enough.
+ * The batch is split into parts of consecutive items, one part is
+ * converted by the calling thread and the others by the pool. The call
+ * returns once all parts are converted. Only one thread may split the
+ * batch at a time, which is either the worker thread or the main loop
+ * while the worker is idle.
+ *
+ * @param worker
+ *      background worker or NULL.
+ *
+ * @param from
+ *      the first second of the range.
+ *
+ * @param until
+ *      the first second after the range.
+ *
+ * @param nsec
+ *      nanoseconds for fractional seconds.
+ *
+ * @return
+ *      nonzero if the batch was converted, zero if the caller has to
+ *      convert it by itself.
+ */
+int
+tz_worker_split(struct tz_worker *worker,
+                time_t from,
+                time_t until,
+                long nsec)
+{
+    struct tz_worker_part part[TZ_THREADS_MAX];
+    int count;
+    int parts;
+    int i;
+
+    if (worker == NULL || worker->pool == NULL)
+        return 0;
+
+    count = worker->plugin->list.batch.count;
+    parts = tz_item_parts(count, worker->threads);
+    if (parts <= 1)
+        return 0;
+
+    for (i = 0; i < parts; i++) {
+        part[i].first = tz_item_part(count, parts, i);
+        part[i].last = tz_item_part(count, parts, i + 1);
+        part[i].from = from;
+        part[i].until = until;
+        part[i].nsec = nsec;
+    }
+
+    g_mutex_lock(&worker->part_lock);
+    worker->parts = parts - 1;
+    g_mutex_unlock(&worker->part_lock);
+
+    for (i = 1; i < parts; i++)
+        g_thread_pool_push(worker->pool, part + i, NULL);
+
+    tz_list_convert_part(worker->plugin, part[0].first, part[0].last,
+                         from, until, nsec);
+
+    g_mutex_lock(&worker->part_lock);
+    while (worker->parts > 0)
+        g_cond_wait(&worker->part_cond, &worker->part_lock);
+    g_mutex_unlock(&worker->part_lock);
+
+    return 1;
+}
+
+#else /* !WORKER_API */
+
+struct tz_worker *
+tz_worker_new(struct tz_plugin *plugin)
+{
+    return NULL;
+}
+
+
+void
+tz_worker_free(struct tz_worker *worker)
+{
+}
+
+
+int
+tz_worker_poll(struct tz_worker *worker, time_t *from, time_t *until)
+{
+    return 1;
+}
+
+
+void
+tz_worker_reset(struct tz_worker *worker)
+{
+}
+
+
+void
+tz_worker_post(struct tz_worker *worker, time_t from, time_t until)
+{
+}
+
+
+void
+tz_worker_threads(struct tz_worker *worker, int threads)
+{
+}
+
+
+int
+tz_worker_split(struct tz_worker *worker,
+                time_t from,
+                time_t until,
+                long nsec)
+{
+    return 0;
+}
+
+#endif /* !WORKER_API */
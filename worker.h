@@ -0,0 +1,46 @@
+/*
+ * Background computation of time strings.
+ * Copyright (C) 2026 Jiri Denemark
+ *
+ * This file is part of gkrellm-tz.
+ *
+ * gkrellm-tz is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/** @file
+ * Background computation of time strings.
+ * @author Jiri Denemark
+ */
+
+#ifndef WORKER_H
+#define WORKER_H
+
+#include <time.h>
+
+struct tz_plugin;
+struct tz_worker;
+
+struct tz_worker *tz_worker_new(struct tz_plugin *plugin);
+void tz_worker_free(struct tz_worker *worker);
+int tz_worker_poll(struct tz_worker *worker, time_t *from, time_t *until);
+void tz_worker_reset(struct tz_worker *worker);
+void tz_worker_post(struct tz_worker *worker, time_t from, time_t until);
+void tz_worker_threads(struct tz_worker *worker, int threads);
+int tz_worker_split(struct tz_worker *worker,
+                    time_t from,
+                    time_t until,
+                    long nsec);
+
+#endif
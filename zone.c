@@ -0,0 +1,243 @@
+/*
+ * Timezone offsets.
+ * Copyright (C) 2026 Jiri Denemark
+ *
+ * This file is part of gkrellm-tz.
+ *
+ * gkrellm-tz is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/** @file
+ * Timezone offsets.
+ * @author Jiri Denemark
+ */
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "arena.h"
+#include "zone.h"
+
+/** How long (in seconds) a probed offset is trusted.
+ * Timezone transitions happen on whole minutes. */
+#define ZONE_PROBE_PERIOD   60
+
+
+/** Set abbreviation of a local time type.
+ * The abbreviation is never empty so that strftime does not need to
+ * consult TZ when formatting %Z; numeric offset is used instead of
+ * a missing abbreviation.
+ *
+ * @param zone
+ *      local time type with gmtoff already set.
+ *
+ * @param abbr
+ *      abbreviation or NULL.
+ *
+ * @return
+ *      nothing.
+ */
+void
+tz_zone_abbr(struct tz_zone *zone, const char *abbr)
+{
+    if (abbr != NULL && *abbr != '\0') {
+        strncpy(zone->abbr, abbr, TZ_ABBR - 1);
+        zone->abbr[TZ_ABBR - 1] = '\0';
+    } else {
+        long off = (zone->gmtoff < 0) ? -zone->gmtoff : zone->gmtoff;
+
+        snprintf(zone->abbr, TZ_ABBR, "%c%02d%02d",
+                 (zone->gmtoff < 0) ? '-' : '+',
+                 (int) (off / 3600 % 100), (int) (off / 60 % 60));
+    }
+}
+
+
+/** Find local time type of a timezone at a given time.
+ * The result is valid from the beginning of the minute containing t until
+ * the next minute starts. Since the lookup temporarily changes TZ
+ * environment variable, it may only be called from the main thread.
+ *
+ * @param timezone
+ *      timezone in a form usable for TZ environment variable.
+ *
+ * @param t
+ *      time for which the offset is requested.
+ *
+ * @param zone
+ *      where to store the result.
+ *
+ * @return
+ *      0 on success, -1 on error (zone is set to UTC for one second).
+ */
+int
+tz_zone_lookup(const char *timezone, time_t t, struct tz_zone *zone)
+{
+    struct tm tm;
+    struct tm *res;
+    char *tz_old;
+    time_t from;
+
+    tz_old = getenv("TZ");
+    setenv("TZ", timezone, 1);
+    tzset();
+
+    res = localtime_r(&t, &tm);
+
+    if (tz_old != NULL)
+        setenv("TZ", tz_old, 1);
+    else
+        unsetenv("TZ");
+    tzset();
+
+    if (res == NULL) {
+        zone->gmtoff = 0;
+        zone->isdst = 0;
+        strcpy(zone->abbr, "UTC");
+        zone->from = t;
+        zone->until = t + 1;
+        return -1;
+    }
+
+    zone->gmtoff = tm.tm_gmtoff;
+    zone->isdst = tm.tm_isdst > 0;
+    tz_zone_abbr(zone, tm.tm_zone);
+
+    from = t - t % ZONE_PROBE_PERIOD;
+    if (t % ZONE_PROBE_PERIOD < 0)
+        from -= ZONE_PROBE_PERIOD;
+    zone->from = from;
+    zone->until = from + ZONE_PROBE_PERIOD;
+
+    return 0;
+}
+
+
+/** Parse a number of one or two digits.
+ *
+ * @param p
+ *      string.
+ *
+ * @param value
+ *      where to store the number.
+ *
+ * @return
+ *      pointer to the first character after the number or NULL if p does
+ *      not start with a digit.
+ */
+static const char *
+zone_number(const char *p, int *value)
+{
+    if (!isdigit((unsigned char) *p))
+        return NULL;
+
+    *value = *p++ - '0';
+    if (isdigit((unsigned char) *p))
+        *value = *value * 10 + *p++ - '0';
+
+    return p;
+}
+
+
+/** Recognize a timezone with a fixed offset from UTC.
+ * Such timezones are "UTC" and "GMT" (with or without "Etc/" prefix),
+ * "Etc/GMT-14" ... "Etc/GMT+12" as in the timezone database, and TZ rule
+ * strings "UTC+hh[:mm[:ss]]" or "UTC-hh[:mm[:ss]]" without DST. In both
+ * cases the sign follows POSIX, positive offsets are west of Greenwich
+ * (UTC-3 and Etc/GMT-3 are three hours ahead of UTC), so the result is
+ * the same as if TZ environment variable was set to the timezone. Local
+ * time type of these timezones never changes, so no timezone file or rule
+ * is needed.
+ *
+ * @param arena
+ *      arena the result is allocated from.
+ *
+ * @param timezone
+ *      timezone name.
+ *
+ * @return
+ *      local time type valid at any time or NULL if timezone does not
+ *      have a fixed offset (or memory cannot be allocated).
+ */
+struct tz_zone *
+tz_zone_fixed(struct tz_arena *arena, const char *timezone)
+{
+    struct tz_zone fixed;
+    struct tz_zone *zone;
+    const char *p = timezone;
+    const char *abbr = NULL;
+    int etc = 0;
+    int hours = 0;
+    int minutes = 0;
+    int seconds = 0;
+    int sign = 1;
+
+    if (strncmp(p, "Etc/", 4) == 0) {
+        etc = 1;
+        p += 4;
+    }
+
+    if (strcmp(p, "UTC") == 0 || strcmp(p, "GMT") == 0) {
+        abbr = p;
+    } else if (strncmp(p, (etc) ? "GMT" : "UTC", 3) == 0
+               && (p[3] == '+' || p[3] == '-')) {
+        /* as in POSIX, positive offsets are west of Greenwich */
+        sign = (p[3] == '+') ? -1 : 1;
+        if ((p = zone_number(p + 4, &hours)) == NULL)
+            return NULL;
+
+        if (etc) {
+            if (*p != '\0' || hours > ((sign < 0) ? 12 : 14))
+                return NULL;
+            if (hours == 0)
+                abbr = "GMT";
+        } else {
+            if (*p == ':'
+                && ((p = zone_number(p + 1, &minutes)) == NULL
+                    || minutes > 59))
+                return NULL;
+            if (*p == ':'
+                && ((p = zone_number(p + 1, &seconds)) == NULL
+                    || seconds > 59))
+                return NULL;
+            if (*p != '\0' || hours > 24)
+                return NULL;
+            abbr = "UTC";
+        }
+    } else {
+        return NULL;
+    }
+
+    fixed.gmtoff = sign * (hours * 3600L + minutes * 60L + seconds);
+    fixed.isdst = 0;
+    fixed.from = TZ_TIME_MIN;
+    fixed.until = TZ_TIME_MAX;
+    if (abbr != NULL) {
+        tz_zone_abbr(&fixed, abbr);
+    } else {
+        /* the timezone database abbreviates Etc/GMT+5 as "-05" */
+        snprintf(fixed.abbr, TZ_ABBR, "%c%02d",
+                 (sign < 0) ? '-' : '+', hours);
+    }
+
+    zone = (struct tz_zone *) tz_arena_alloc(arena, sizeof(struct tz_zone));
+    if (zone != NULL)
+        *zone = fixed;
+
+    return zone;
+}
@@ -0,0 +1,79 @@
+/*
+ * Timezone offsets.
+ * Copyright (C) 2026 Jiri Denemark
+ *
+ * This file is part of gkrellm-tz.
+ *
+ * gkrellm-tz is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/** @file
+ * Timezone offsets.
+ * @author Jiri Denemark
+ */
+
+#ifndef ZONE_H
+#define ZONE_H
+
+#include <limits.h>
+#include <time.h>
+
+#include "arena.h"
+
+/** Length of a buffer for timezone abbreviation. */
+#define TZ_ABBR     16
+
+/** The earliest and the latest representable time (time_t is long on
+ * all systems GKrellM runs on). */
+#define TZ_TIME_MIN ((time_t) LONG_MIN)
+#define TZ_TIME_MAX ((time_t) LONG_MAX)
+
+
+/** Local time type of a timezone valid for a range of time. */
+struct tz_zone {
+    /** Offset from UTC in seconds, positive east of Greenwich. */
+    long gmtoff;
+    /** Nonzero if daylight saving time is in effect. */
+    int isdst;
+    /** Timezone abbreviation, e.g. "CEST". */
+    char abbr[TZ_ABBR];
+    /** The first second this local time type is known to be valid. */
+    time_t from;
+    /** The first second this local time type is no longer known to be
+     * valid. */
+    time_t until;
+};
+
+
+/** Check whether zone information is valid at a given time.
+ *
+ * @param zone
+ *      pointer to zone information.
+ *
+ * @param t
+ *      time to check.
+ *
+ * @return
+ *      nonzero if zone can be used at time t.
+ */
+#define tz_zone_valid(zone, t)  \
+    ((zone)->from <= (t) && (t) < (zone)->until)
+
+
+void tz_zone_abbr(struct tz_zone *zone, const char *abbr);
+int tz_zone_lookup(const char *timezone, time_t t, struct tz_zone *zone);
+struct tz_zone *tz_zone_fixed(struct tz_arena *arena, const char *timezone);
+
+#endif